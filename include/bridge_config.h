@@ -0,0 +1,155 @@
+/************************************************************************
+Bridge Config - Runtime settings read lock-free by the core1 hot path
+New settings are staged in a shadow block and published with a single
+atomic pointer swap (RCU-style: core1 marks quiescent points)
+*************************************************************************/
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+#define BRIDGE_CONFIG_VERSION     2
+#define BRIDGE_CONFIG_REPORT_ID   1   // Feature report: config block (get/set)
+#define BRIDGE_DIAG_REPORT_ID     2   // Feature report: diagnostics (get only)
+#define BRIDGE_REPORT_SIZE        63  // Feature payload size (without report ID)
+
+#define BRIDGE_BUTTON_NONE        0xFF
+#define BRIDGE_CURVE_POINTS       9   // Response at 0/8 .. 8/8 of full deflection
+#define BRIDGE_STICK_MAX          2047  // Largest 12-bit deflection from center
+#define BRIDGE_CURVE_MAX          2048
+
+// Config flags
+#define BRIDGE_FLAG_GYRO_AIM      0x01
+
+// Output button bits - one layout for every input path (Pro 2 map, keyboard/mouse)
+enum OutputButtons {
+  OutButton_Y = 0,
+  OutButton_X,
+  OutButton_B,
+  OutButton_A,
+  OutButton_R,
+  OutButton_ZR,
+  OutButton_Minus,
+  OutButton_Plus,
+  OutButton_RightStick,
+  OutButton_LeftStick,
+  OutButton_Home,
+  OutButton_Capture,
+  OutButton_L,
+  OutButton_ZL,
+  // PC layout only
+  OutButton_GL = 16,
+  OutButton_GR,
+  OutButton_C,
+  OutButton_Headset,
+  OutButton_SR_Right,
+  OutButton_SL_Right,
+  OutButton_SR_Left,
+  OutButton_SL_Left
+};
+
+// Output modes
+#define BRIDGE_OUTPUT_SWITCH      0   // HORIPAD layout: 16 buttons, 8-bit axes
+#define BRIDGE_OUTPUT_PC_HIRES    1   // PC layout: 32 buttons, 16-bit axes
+
+// Output mode used until a config says otherwise
+#ifndef BRIDGE_OUTPUT_MODE
+#define BRIDGE_OUTPUT_MODE BRIDGE_OUTPUT_SWITCH
+#endif
+
+// Diagnostic flags
+#define BRIDGE_DIAG_RESET_STATS   0x01  // Clear counters when the config is written
+#define BRIDGE_DIAG_CLEAR_DEVICE_CACHE 0x02  // Forget cached controller profiles
+
+// Config block as sent over the vendor HID interface
+typedef struct __attribute__((packed)) {
+  uint8_t version;              // BRIDGE_CONFIG_VERSION
+  uint8_t flags;                // BRIDGE_FLAG_*
+  uint8_t output_interval_ms;   // Gamepad poll interval, applied at enumeration
+  uint8_t diag_flags;           // BRIDGE_DIAG_*
+  uint8_t button_map[32];       // Pro 2 button bit -> output button (0-31 or BRIDGE_BUTTON_NONE)
+  uint16_t stick_deadzone;      // Per-axis distance from center in 12-bit units
+  uint16_t stick_curve[BRIDGE_CURVE_POINTS];  // Output magnitude (0-2048) per input step
+  int16_t gyro_sensitivity;     // Q8.8 stick units per gyro count
+  uint16_t gyro_deadband;       // Raw gyro counts ignored around zero
+  uint8_t gyro_ratchet_bit;     // Pro 2 button bit that suspends aiming (BRIDGE_BUTTON_NONE = off)
+  uint8_t output_mode;          // BRIDGE_OUTPUT_*, applied at enumeration
+} BridgeConfigData_t;
+
+static_assert(sizeof(BridgeConfigData_t) <= BRIDGE_REPORT_SIZE, "config must fit one feature report");
+
+// Diagnostics as sent over the vendor HID interface
+typedef struct __attribute__((packed)) {
+  uint8_t version;
+  uint8_t reserved[3];
+  uint32_t reports_in;          // Input reports forwarded
+  uint32_t reports_sent;        // Gamepad reports accepted by the endpoint
+  uint32_t send_busy;           // Gamepad reports dropped on a busy endpoint
+  uint32_t config_generation;   // Number of configs published since boot
+  uint32_t gyro_max_cycles;
+  uint32_t gyro_over_budget;
+  uint32_t taps_rescued;        // Presses released between reports, held for one report
+  uint32_t telemetry_dropped;   // Telemetry records the reader did not collect in time
+  uint32_t attach_to_report_us; // Host port attach to first input report (last attach)
+  uint32_t cache_hits;          // Controllers mounted with a stored report ID filter
+} BridgeDiag_t;
+
+static_assert(sizeof(BridgeDiag_t) <= BRIDGE_REPORT_SIZE, "diagnostics must fit one feature report");
+
+// Published config with values precomputed for the hot path
+typedef struct {
+  BridgeConfigData_t data;
+  uint32_t deadzone_scale;      // Q16 factor stretching (|d| - deadzone) back to full range
+  uint32_t ratchet_mask;        // gyro_ratchet_bit as a mask
+} BridgeConfig_t;
+
+// Hot path counters (written by core1, read by core0)
+typedef struct {
+  volatile uint32_t reports_in;
+  volatile uint32_t reports_sent;
+  volatile uint32_t send_busy;
+  volatile uint32_t taps_rescued;
+  volatile uint32_t telemetry_dropped;
+  volatile uint32_t attach_to_report_us;
+  volatile uint32_t cache_hits;
+} BridgeStats_t;
+
+extern BridgeStats_t bridgeStats;
+
+// Fill a config block with the compile-time defaults
+void bridgeConfigDefaults(BridgeConfigData_t* data);
+
+// Check a config block received from the host
+bool bridgeConfigValid(const BridgeConfigData_t* data);
+
+class ConfigStore {
+  private:
+    BridgeConfig_t blocks[2];
+    std::atomic<const BridgeConfig_t*> active;
+    std::atomic<uint32_t> reader_epoch;  // Bumped by core1 at each quiescent point
+    uint32_t retire_epoch;               // reader_epoch when the shadow block was retired
+    uint32_t generation;
+
+  public:
+    ConfigStore();
+
+    // Core1: current config, valid until the next quiescent()
+    const BridgeConfig_t* read() const {
+      return active.load(std::memory_order_acquire);
+    }
+
+    // Core1: no config pointer is held past this point
+    void quiescent() {
+      reader_epoch.store(reader_epoch.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+      // Epoch store before the next read() load - pairs with the fence in publish()
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    // Core0: stage data in the shadow block and swap it in.
+    // Returns false if invalid or core1 may still be reading the shadow block.
+    bool publish(const BridgeConfigData_t* data);
+
+    uint32_t getGeneration() const { return generation; }
+};
+
+extern ConfigStore configStore;
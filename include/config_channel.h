@@ -0,0 +1,50 @@
+/************************************************************************
+Config Channel - Vendor-defined HID interface for live configuration
+Feature reports read/write the bridge config and read diagnostics.
+Output mode/interval changes are stored in flash and re-enumerate
+through a warm reboot.
+*************************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "Adafruit_TinyUSB.h"
+#include "bridge_config.h"
+
+// Vendor-defined HID Report Descriptor (feature reports only)
+uint8_t const desc_hid_report_config[] = {
+  0x06, 0x00, 0xFF,  // Usage Page (Vendor Defined 0xFF00)
+  0x09, 0x01,        // Usage (0x01)
+  0xA1, 0x01,        // Collection (Application)
+  0x15, 0x00,        //   Logical Minimum (0)
+  0x26, 0xFF, 0x00,  //   Logical Maximum (255)
+  0x75, 0x08,        //   Report Size (8)
+  0x95, BRIDGE_REPORT_SIZE,       //   Report Count (63)
+  0x85, BRIDGE_CONFIG_REPORT_ID,  //   Report ID (1) - config block
+  0x09, 0x02,        //   Usage (0x02)
+  0xB1, 0x02,        //   Feature (Data,Var,Abs)
+  0x85, BRIDGE_DIAG_REPORT_ID,    //   Report ID (2) - diagnostics
+  0x09, 0x03,        //   Usage (0x03)
+  0xB1, 0x03,        //   Feature (Const,Var,Abs)
+  0xC0,              // End Collection
+};
+
+class ConfigChannel {
+  private:
+    Adafruit_USBD_HID usb_hid;
+
+  public:
+    ConfigChannel() : usb_hid() {}
+
+    // Restore a config carried across a re-enumeration reboot, or the stored output
+    // mode/interval at power-up - after the device cache loads, before the gamepad reads it
+    void restore();
+
+    // Add the interface - after the gamepad's, before the gamepad waits for enumeration
+    void begin();
+
+    // Core0: publish a config the host wrote, reboot once one that changes the
+    // descriptors has been acknowledged
+    void poll();
+};
+
+extern ConfigChannel configChannel;
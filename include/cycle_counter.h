@@ -0,0 +1,31 @@
+/************************************************************************
+Cycle Counter - DWT CYCCNT of the calling core
+arduino-pico's rp2040.getCycleCount() is SysTick-based and only ticks on
+cores it set up; core1 is started with multicore_launch_core1, so the
+timed stages enable and read their own core's DWT counter instead
+*************************************************************************/
+
+#pragma once
+#include <stdint.h>
+
+#if defined(ARDUINO_ARCH_RP2040)
+#include <pico.h>
+#endif
+
+#if defined(ARDUINO_ARCH_RP2040) && PICO_RP2350
+#include <hardware/structs/m33.h>
+
+// Each M33 has a private DWT - call once on the core that will read it
+static inline void cycleCounterBegin() {
+  m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+  m33_hw->dwt_cyccnt = 0;
+  m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+}
+
+static inline uint32_t cycleCount() { return m33_hw->dwt_cyccnt; }
+#else
+// Host builds (latency simulator, tests) and the M0+ RP2040 (no DWT): always 0,
+// so cycle statistics read 0 there
+static inline void cycleCounterBegin() {}
+static inline uint32_t cycleCount() { return 0; }
+#endif
@@ -0,0 +1,97 @@
+/************************************************************************
+Device Cache - Input report ID of each controller model, kept in flash
+Keyed by VID/PID, interface and report descriptor; a re-plugged Pro 2 / Pro
+drops other report IDs (subcommand replies, status) from its first report.
+The image also holds the output mode/interval chosen at power-up
+*************************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "pro_controller_output.h"
+
+#define DEVICE_CACHE_MAGIC      0x43445032  // "2PDC"
+#define DEVICE_CACHE_VERSION    3
+#define DEVICE_CACHE_ENTRIES    8
+#define DEVICE_CACHE_ROUTES     4    // Mounted HID instances (CFG_TUH_HID)
+
+// One controller interface whose input stream was identified (every field naturally aligned)
+typedef struct __attribute__((packed, aligned(4))) {
+  uint16_t vid;
+  uint16_t pid;
+  uint32_t desc_hash;         // FNV-1a of the HID report descriptor
+  uint8_t instance;           // HID interface index on the device
+  uint8_t decoder;            // InputDecoder (Pro 2 or Pro; DECODER_UNKNOWN = free entry)
+  uint8_t report_id;          // First byte of its input reports - others are dropped
+  uint8_t reserved;
+  uint32_t stamp;             // Store order, oldest is replaced first
+} DeviceProfile_t;
+
+// Flash image (arduino-pico EEPROM emulation)
+typedef struct __attribute__((packed, aligned(4))) {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t output_mode;        // BRIDGE_OUTPUT_* to enumerate with at power-up
+  uint8_t output_interval_ms; // 0 = none stored (build defaults)
+  uint8_t reserved;
+  uint32_t stamp;
+  DeviceProfile_t entries[DEVICE_CACHE_ENTRIES];
+  uint32_t crc;               // FNV-1a of everything above
+} DeviceCacheImage_t;
+
+static_assert(sizeof(DeviceProfile_t) == 16, "profile layout is stored in flash");
+
+// Live state of one mounted HID instance
+typedef struct {
+  uint8_t dev_addr;           // 0 = slot free
+  uint8_t instance;
+  DeviceProfile_t profile;    // decoder/report_id set from the cache or the first input report
+  StickCal_t cal;             // Learned per connection, never stored
+} InputRoute_t;
+
+class DeviceCache {
+  private:
+    DeviceCacheImage_t image;
+    InputRoute_t routes[DEVICE_CACHE_ROUTES];
+    bool dirty;                     // image differs from flash
+    volatile bool clear_requested;
+
+    InputRoute_t* findRoute(uint8_t dev_addr, uint8_t instance);
+    const DeviceProfile_t* lookup(const DeviceProfile_t* key) const;
+    void store(const DeviceProfile_t* p);
+    void write(bool port_empty_only);
+
+  public:
+    DeviceCache();
+
+    // Core0 setup: load and validate the flash image
+    void begin();
+
+    // Core1 (TinyUSB callbacks): start/stop routing an instance
+    void mount(uint8_t dev_addr, uint8_t instance, const uint8_t* desc_report, uint16_t desc_len);
+    void unmount(uint8_t dev_addr, uint8_t instance);
+
+    // Core1: forward a report, dropping other IDs once the input report ID is known
+    void forward(uint8_t dev_addr, uint8_t instance, const uint8_t* report, uint16_t len,
+                 ProControllerOutput* output);
+
+    // Core1: the instance resolved to a decoder that reports at a fixed rate (Pro 2, Pro)
+    bool streaming(uint8_t dev_addr, uint8_t instance);
+
+    // Core1 loop: park in SRAM while core0 writes flash
+    void core1Park();
+
+    // Core0 loop: write changes once the host port is empty
+    void poll();
+
+    // Core0 setup: output mode/interval last stored (false if none)
+    bool storedOutput(uint8_t* mode, uint8_t* interval_ms) const;
+
+    // Core0: keep the output mode/interval for power-up - written at once, controller
+    // attached or not, as the caller reboots to re-enumerate right after
+    void storeOutput(uint8_t mode, uint8_t interval_ms);
+
+    // Forget every profile (written at the next poll with the port empty)
+    void clear() { clear_requested = true; }
+};
+
+extern DeviceCache deviceCache;
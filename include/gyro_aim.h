@@ -0,0 +1,86 @@
+/************************************************************************
+Gyro Aim - Pro 2 gyro to right stick mapping
+Fixed-point, integrates every IMU sample between output reports
+*************************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "bridge_config.h"
+
+// Gyro aiming disabled by default (enable with -DGYRO_AIM_ENABLED=1 or over the config channel)
+#ifndef GYRO_AIM_ENABLED
+#define GYRO_AIM_ENABLED 0
+#endif
+
+// Default sensitivity in Q8.8 (stick units per raw gyro count, 0x0100 = 1.0)
+#ifndef GYRO_AIM_SENSITIVITY
+#define GYRO_AIM_SENSITIVITY 0x0030
+#endif
+
+// Default raw gyro counts ignored around zero (removes drift at rest)
+#ifndef GYRO_AIM_DEADBAND
+#define GYRO_AIM_DEADBAND 24
+#endif
+
+// Default Pro 2 button held to suspend aiming and re-center (GL)
+#ifndef GYRO_AIM_RATCHET_MASK
+#define GYRO_AIM_RATCHET_MASK 0x02000000
+#endif
+
+// Gyro axis driving stick X (yaw) and Y (pitch)
+#ifndef GYRO_AIM_AXIS_X
+#define GYRO_AIM_AXIS_X 2
+#endif
+#ifndef GYRO_AIM_AXIS_Y
+#define GYRO_AIM_AXIS_Y 0
+#endif
+
+// Per-report cycle budget for apply() (600 cycles = 5us at 120 MHz). An estimate, not a
+// measurement: set it from gyro_max_cycles (pro2cfg diag) once read on hardware
+#ifndef GYRO_AIM_CYCLE_BUDGET
+#define GYRO_AIM_CYCLE_BUDGET 600
+#endif
+
+class GyroAim {
+  private:
+    int32_t sum_x;        // Gyro counts summed since last sent report
+    int32_t sum_y;
+    int32_t samples;      // IMU samples in the current window
+    int32_t frac_x;       // Q8 remainder carried into the next window
+    int32_t frac_y;
+    int32_t pend_frac_x;  // Remainder of the report waiting to be sent
+    int32_t pend_frac_y;
+    uint32_t max_cycles;
+    uint32_t over_budget;
+
+  public:
+    GyroAim() { reset(); }
+
+    // Clear accumulated motion (on disconnect or ratchet)
+    void reset() {
+      sum_x = sum_y = 0;
+      samples = 0;
+      frac_x = frac_y = 0;
+      pend_frac_x = pend_frac_y = 0;
+      max_cycles = 0;
+      over_budget = 0;
+    }
+
+    // Integrate one IMU sample and add the window's motion to the 12-bit right stick
+    void apply(const BridgeConfig_t* cfg, const int16_t gyro[3], uint32_t buttons32,
+               uint16_t* rx, uint16_t* ry);
+
+    // Report containing the current window was sent - start a new window
+    void commit() {
+      sum_x = sum_y = 0;
+      samples = 0;
+      frac_x = pend_frac_x;
+      frac_y = pend_frac_y;
+    }
+
+    // Worst-case apply() cost in cycles and how often the budget was exceeded
+    uint32_t maxCycles() const { return max_cycles; }
+    uint32_t overBudget() const { return over_budget; }
+};
+
+extern GyroAim gyroAim;
@@ -46,18 +46,6 @@ enum NSButtons {
   NSButton_Reserved2
 };
 
-// D-Pad directions
-typedef uint8_t NSDirection_t;
-#define NSGAMEPAD_DPAD_UP           0
-#define NSGAMEPAD_DPAD_UP_RIGHT     1
-#define NSGAMEPAD_DPAD_RIGHT        2
-#define NSGAMEPAD_DPAD_DOWN_RIGHT   3
-#define NSGAMEPAD_DPAD_DOWN         4
-#define NSGAMEPAD_DPAD_DOWN_LEFT    5
-#define NSGAMEPAD_DPAD_LEFT         6
-#define NSGAMEPAD_DPAD_UP_LEFT      7
-#define NSGAMEPAD_DPAD_CENTERED     0xF
-
 // Button names lookup table
 static const char* NS_BUTTON_NAMES[] = {
   "Y",
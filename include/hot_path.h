@@ -0,0 +1,16 @@
+/************************************************************************
+Hot Path Placement - Keep the input -> output path in SRAM
+Functions tagged HOT_PATH land in .time_critical.hotpath.*, which the
+runtime copies to RAM at boot; tools/hot_path.py moves the library
+functions they call and fails the build if any of them stays in flash
+*************************************************************************/
+
+#pragma once
+
+#if defined(ARDUINO_ARCH_RP2040)
+// Usage: void HOT_PATH(forwardHIDReport)(const uint8_t* report, ...)
+#define HOT_PATH(func) __attribute__((section(".time_critical.hotpath." #func))) func
+#else
+// Host builds (latency simulator, CLI) have no XIP to avoid
+#define HOT_PATH(func) func
+#endif
@@ -0,0 +1,51 @@
+/************************************************************************
+Keyboard & Mouse Translator - Boot protocol keyboard/mouse to gamepad
+Mouse motion is accumulated across every report in an output window
+*************************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "pro_controller_output.h"
+
+// Right stick units (x256) per mouse count per millisecond
+#ifndef KBM_MOUSE_GAIN
+#define KBM_MOUSE_GAIN 0x0400
+#endif
+
+// Shortest window used for velocity (avoids spikes on back-to-back sends)
+#define KBM_MIN_WINDOW_US  1000
+
+// Drain and recenter the right stick after this long without mouse motion
+#define KBM_MOUSE_IDLE_US  8000
+
+class KbmTranslator {
+  private:
+    uint16_t key_buttons;      // Buttons held on the keyboard
+    uint16_t mouse_buttons;    // Buttons held on the mouse
+    uint8_t dpad;
+    uint8_t lx, ly;            // WASD
+    int32_t acc_x, acc_y;      // Mouse counts not yet delivered in a sent report
+    int32_t pend_x, pend_y;    // Counts carried by the report last handed to the endpoint
+    uint32_t window_start_us;  // Last successful send
+    uint32_t last_motion_us;
+    bool stick_active;
+    bool dirty;                // State changed since the last sent report
+
+    bool send(ProControllerOutput* output, uint32_t now);
+
+  public:
+    KbmTranslator() { reset(); }
+
+    void reset();
+
+    // Boot protocol keyboard report (modifiers, reserved, 6 keycodes)
+    void keyboardReport(const uint8_t* report, uint16_t len, ProControllerOutput* output);
+
+    // Boot protocol mouse report (buttons, dx, dy[, wheel])
+    void mouseReport(const uint8_t* report, uint16_t len, ProControllerOutput* output);
+
+    // Core1 loop: retry unsent changes, drain leftover motion and recenter once the mouse stops
+    void idle(ProControllerOutput* output);
+};
+
+extern KbmTranslator kbmTranslator;
@@ -0,0 +1,60 @@
+/************************************************************************
+Power Idle - Low-power mode while nothing is plugged into the host port
+clk_sys drops to 48 MHz and core1 sleeps between events; full speed is
+restored as soon as the port sees a device, before TinyUSB enumerates it
+*************************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "bridge_config.h"
+
+// Idle clock scaling and sleep (0 = always-on, attach timing is still measured)
+#ifndef POWER_IDLE_ENABLED
+#define POWER_IDLE_ENABLED 1
+#endif
+
+// Longest core1 sleep between host port checks
+#define POWER_IDLE_WAKE_US     1000
+
+// Stay at full speed this long after the port last saw a device (covers bus reset SE0)
+#define POWER_IDLE_HOLDOFF_MS  1000
+
+class PowerIdle {
+  private:
+    bool slow;                     // clk_sys at the idle frequency
+    volatile bool connected;       // Host port line state at the last poll
+    uint32_t last_connected_ms;
+    volatile uint8_t devices;      // Mounted host devices
+    volatile uint32_t attach_us;   // Attach time awaiting its first report (0 = none)
+
+    void setSpeed(bool low);
+    void sawAttach();
+
+  public:
+    PowerIdle() : slow(false), connected(false), last_connected_ms(0), devices(0), attach_us(0) {}
+
+    // Stop clocks the bridge never uses
+    void begin();
+
+    // Core1: call before tuh_task() - sleeps while idle, restores full speed on attach
+    void poll();
+
+    void deviceMounted() { devices++; }
+    void deviceUnmounted() { if (devices > 0) devices--; }
+
+    // Core1: an input report arrived - closes the attach-to-first-report measurement
+    void reportReceived() {
+      uint32_t at = attach_us;
+      if (at) {
+        bridgeStats.attach_to_report_us = time_us_32() - at;
+        attach_us = 0;
+      }
+    }
+
+    bool isIdle() const { return slow; }
+
+    // Nothing attached or mounted on the host port (readable from core0)
+    bool portEmpty() const { return !connected && devices == 0; }
+};
+
+extern PowerIdle powerIdle;
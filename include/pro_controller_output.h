@@ -6,11 +6,23 @@ Mimics real Switch Pro Controller USB descriptors exactly
 #pragma once
 #include <Arduino.h>
 #include "Adafruit_TinyUSB.h"
+#include "bridge_config.h"
 
 // Switch-compatible Gamepad VID/PID (Hori is officially licensed by Nintendo)
 #define GAMEPAD_VID  0x0F0D  // Hori Co., Ltd (Nintendo licensed)
 #define GAMEPAD_PID  0x00C1  // HORIPAD for Nintendo Switch
 
+// PC high-resolution mode enumerates as its own device: host drivers that know 0F0D:00C1
+// (e.g. SDL's HIDAPI Switch driver) expect the 7-byte HORIPAD report, not the 13-byte one.
+// Defaults to the pid.codes test VID/PID - override with your own allocation to distribute
+#ifndef GAMEPAD_PC_VID
+#define GAMEPAD_PC_VID  0x1209  // pid.codes
+#endif
+#ifndef GAMEPAD_PC_PID
+#define GAMEPAD_PC_PID  0x0001  // pid.codes test PID
+#endif
+#define GAMEPAD_PC_BCD  0x0200  // bcdDevice 2.00 - PC layout
+
 // Simple Generic Gamepad HID Report Descriptor
 uint8_t const desc_hid_report_pro_controller[] = {
   0x05, 0x01,        // Usage Page (Generic Desktop Ctrls)
@@ -49,6 +61,55 @@ uint8_t const desc_hid_report_pro_controller[] = {
   0xC0,              // End Collection
 };
 
+// PC High-Resolution Gamepad HID Report Descriptor (32 buttons, 16-bit axes)
+uint8_t const desc_hid_report_pc_hires[] = {
+  0x05, 0x01,        // Usage Page (Generic Desktop Ctrls)
+  0x09, 0x05,        // Usage (Game Pad)
+  0xA1, 0x01,        // Collection (Application)
+  0x15, 0x00,        //   Logical Minimum (0)
+  0x25, 0x01,        //   Logical Maximum (1)
+  0x35, 0x00,        //   Physical Minimum (0)
+  0x45, 0x01,        //   Physical Maximum (1)
+  0x75, 0x01,        //   Report Size (1)
+  0x95, 0x20,        //   Report Count (32)
+  0x05, 0x09,        //   Usage Page (Button)
+  0x19, 0x01,        //   Usage Minimum (0x01)
+  0x29, 0x20,        //   Usage Maximum (0x20)
+  0x81, 0x02,        //   Input (Data,Var,Abs)
+  0x05, 0x01,        //   Usage Page (Generic Desktop Ctrls)
+  0x25, 0x07,        //   Logical Maximum (7)
+  0x46, 0x3B, 0x01,  //   Physical Maximum (315)
+  0x75, 0x04,        //   Report Size (4)
+  0x95, 0x01,        //   Report Count (1)
+  0x65, 0x14,        //   Unit (System: English Rotation, Length: Centimeter)
+  0x09, 0x39,        //   Usage (Hat switch)
+  0x81, 0x42,        //   Input (Data,Var,Abs,Null State)
+  0x65, 0x00,        //   Unit (None)
+  0x95, 0x01,        //   Report Count (1)
+  0x81, 0x01,        //   Input (Const,Array,Abs)
+  0x27, 0xFF, 0xFF, 0x00, 0x00,  //   Logical Maximum (65535)
+  0x47, 0xFF, 0xFF, 0x00, 0x00,  //   Physical Maximum (65535)
+  0x09, 0x30,        //   Usage (X)
+  0x09, 0x31,        //   Usage (Y)
+  0x09, 0x32,        //   Usage (Z)
+  0x09, 0x35,        //   Usage (Rz)
+  0x75, 0x10,        //   Report Size (16)
+  0x95, 0x04,        //   Report Count (4)
+  0x81, 0x02,        //   Input (Data,Var,Abs)
+  0xC0,              // End Collection
+};
+
+// Output d-pad (hat switch) directions, both layouts
+#define OUTPUT_HAT_UP          0
+#define OUTPUT_HAT_UP_RIGHT    1
+#define OUTPUT_HAT_RIGHT       2
+#define OUTPUT_HAT_DOWN_RIGHT  3
+#define OUTPUT_HAT_DOWN        4
+#define OUTPUT_HAT_DOWN_LEFT   5
+#define OUTPUT_HAT_LEFT        6
+#define OUTPUT_HAT_UP_LEFT     7
+#define OUTPUT_HAT_CENTERED    8  // Outside the logical range = null state
+
 // Gamepad Report Structure (7 bytes to match descriptor)
 typedef struct __attribute__((packed)) {
   uint16_t buttons;    // 16 buttons (2 bytes)
@@ -59,92 +120,268 @@ typedef struct __attribute__((packed)) {
   uint8_t ry;          // Right stick Y (0-255)
 } ProControllerReport_t;
 
+// PC High-Resolution Report Structure (13 bytes to match descriptor)
+typedef struct __attribute__((packed)) {
+  uint32_t buttons;    // 32 buttons - 0-15 as above, then GL, GR, C, Headset, SR/SL
+  uint8_t hat;         // D-pad (hat switch) - 4 bits + 4 bits padding
+  uint16_t lx;         // Left stick X (0-65535)
+  uint16_t ly;         // Left stick Y (0-65535)
+  uint16_t rx;         // Right stick X (0-65535)
+  uint16_t ry;         // Right stick Y (0-65535)
+} ProControllerHiResReport_t;
+
 class ProControllerOutput {
   private:
     Adafruit_USBD_HID usb_hid;
-    ProControllerReport_t report;
+    bool hires;        // PC layout, fixed at enumeration
+    uint32_t latched;  // Buttons seen pressed since the last report the endpoint accepted
+    bool release_pending;              // Last accepted report held taps that are up by now
+    volatile bool keepalive_pending;   // Set by core0, sent by core1
+    union {
+      ProControllerReport_t sw;
+      ProControllerHiResReport_t pc;
+    } report;          // Setters write straight into the active layout
+
+    // Accepted report carried these taps - latch afresh until the next one,
+    // and release them as soon as the endpoint is free
+    void rescued(uint32_t taps) {
+      latched = 0;
+      release_pending = taps != 0;
+      for (; taps; taps &= taps - 1) {
+        bridgeStats.taps_rescued++;  // Bit loop - popcount is a libgcc call in flash
+      }
+    }
+
+    // Widen 8-bit / 12-bit axes to 16 bits by bit replication
+    static uint16_t axis16From8(uint8_t v) { return (v << 8) | v; }
+    static uint16_t axis16From12(uint16_t v) { return (v << 4) | (v >> 8); }
     
   public:
-    ProControllerOutput() : usb_hid() {
+    ProControllerOutput()
+      : usb_hid(), hires(false), latched(0), release_pending(false), keepalive_pending(false) {
       // Initialize report to neutral state
       memset(&report, 0, sizeof(report));
-      report.lx = 0x80;  // Center
-      report.ly = 0x80;
-      report.rx = 0x80;
-      report.ry = 0x80;
-      report.hat = 0x08; // Centered
+      reset();
     }
     
     void begin() {
-      // Set Hori VID/PID (Nintendo Switch compatible)
-      USBDevice.setID(GAMEPAD_VID, GAMEPAD_PID);
-      USBDevice.setManufacturerDescriptor("HORI CO.,LTD.");
-      USBDevice.setProductDescriptor("HORIPAD S");
+      const BridgeConfig_t* cfg = configStore.read();
+      hires = cfg->data.output_mode == BRIDGE_OUTPUT_PC_HIRES;
+      reset();
+
+      if (hires) {
+        // PC layout - a distinct identity so nothing mistakes it for a HORIPAD
+        USBDevice.setID(GAMEPAD_PC_VID, GAMEPAD_PC_PID);
+        USBDevice.setDeviceVersion(GAMEPAD_PC_BCD);
+        USBDevice.setManufacturerDescriptor("Pro 2 Bridge");
+        USBDevice.setProductDescriptor("Pro 2 Bridge (PC Hi-Res)");
+      } else {
+        // Set Hori VID/PID (Nintendo Switch compatible)
+        USBDevice.setID(GAMEPAD_VID, GAMEPAD_PID);
+        USBDevice.setManufacturerDescriptor("HORI CO.,LTD.");
+        USBDevice.setProductDescriptor("HORIPAD S");
+      }
       
       // Configure HID gamepad
-      usb_hid.setPollInterval(4);
-      usb_hid.setReportDescriptor(desc_hid_report_pro_controller, sizeof(desc_hid_report_pro_controller));
+      usb_hid.setPollInterval(cfg->data.output_interval_ms);
+      if (hires) {
+        usb_hid.setReportDescriptor(desc_hid_report_pc_hires, sizeof(desc_hid_report_pc_hires));
+      } else {
+        usb_hid.setReportDescriptor(desc_hid_report_pro_controller, sizeof(desc_hid_report_pro_controller));
+      }
       usb_hid.begin();
-      
-      // Wait for USB to be ready
+    }
+
+    // Wait for the host to enumerate - after every other interface is added
+    void waitMounted() {
       while (!USBDevice.mounted()) delay(1);
     }
+
+    // True when enumerated with the PC high-resolution layout
+    bool isHiRes() const {
+      return hires;
+    }
     
-    // Set button state (bit mask)
-    void setButtons(uint16_t buttons) {
-      report.buttons = buttons;
+    // Set button state (bit mask; bits 16+ only exist in the PC layout)
+    void setButtons(uint32_t buttons) {
+      latched |= buttons;
+      if (hires) {
+        report.pc.buttons = buttons;
+      } else {
+        report.sw.buttons = (uint16_t)buttons;
+      }
     }
     
     // Set individual button
     void setButton(uint8_t button_num, bool pressed) {
-      if (button_num < 16) {
+      if (pressed && button_num < 32) {
+        latched |= (1UL << button_num);
+      }
+      if (hires && button_num < 32) {
+        if (pressed) {
+          report.pc.buttons |= (1UL << button_num);
+        } else {
+          report.pc.buttons &= ~(1UL << button_num);
+        }
+      } else if (button_num < 16) {
         if (pressed) {
-          report.buttons |= (1 << button_num);
+          report.sw.buttons |= (1 << button_num);
         } else {
-          report.buttons &= ~(1 << button_num);
+          report.sw.buttons &= ~(1 << button_num);
         }
       }
     }
     
     // Set D-pad direction (0-7 = directions, 8 = center)
     void setDPad(uint8_t direction) {
-      report.hat = direction;
+      if (hires) {
+        report.pc.hat = direction;
+      } else {
+        report.sw.hat = direction;
+      }
     }
     
     // Set analog sticks (0-255, center = 128)
     void setLeftStick(uint8_t x, uint8_t y) {
-      report.lx = x;
-      report.ly = y;
+      if (hires) {
+        report.pc.lx = axis16From8(x);
+        report.pc.ly = axis16From8(y);
+      } else {
+        report.sw.lx = x;
+        report.sw.ly = y;
+      }
     }
     
     void setRightStick(uint8_t x, uint8_t y) {
-      report.rx = x;
-      report.ry = y;
+      if (hires) {
+        report.pc.rx = axis16From8(x);
+        report.pc.ry = axis16From8(y);
+      } else {
+        report.sw.rx = x;
+        report.sw.ry = y;
+      }
+    }
+
+    // Set analog sticks at full resolution (0-4095, center = 2048)
+    void setLeftStick12(uint16_t x, uint16_t y) {
+      if (hires) {
+        report.pc.lx = axis16From12(x);
+        report.pc.ly = axis16From12(y);
+      } else {
+        report.sw.lx = x >> 4;
+        report.sw.ly = y >> 4;
+      }
+    }
+
+    void setRightStick12(uint16_t x, uint16_t y) {
+      if (hires) {
+        report.pc.rx = axis16From12(x);
+        report.pc.ry = axis16From12(y);
+      } else {
+        report.sw.rx = x >> 4;
+        report.sw.ry = y >> 4;
+      }
     }
     
-    // Send the current report to the host
-    bool sendReport() {
-      return usb_hid.sendReport(0, &report, sizeof(report));
+    // True if the endpoint can take a report now
+    bool ready() {
+      return usb_hid.ready();
     }
     
+    // Core1: send the current report to the host. A button pressed and released since
+    // the last accepted report is held in this one, and dropped from the next.
+    bool sendReport();
+
+    // Core0: ask core1 to resend the current state (keepalive)
+    void requestKeepalive() {
+      keepalive_pending = true;
+    }
+
+    // Core1 loop: send a held tap's release or a requested keepalive once the endpoint is free
+    void service();
+    
     // Reset to neutral state
     void reset() {
-      report.buttons = 0;
-      report.hat = 0x08;
-      report.lx = 0x80;
-      report.ly = 0x80;
-      report.rx = 0x80;
-      report.ry = 0x80;
+      latched = 0;
+      release_pending = false;
+      if (hires) {
+        report.pc.buttons = 0;
+        report.pc.hat = OUTPUT_HAT_CENTERED;
+        report.pc.lx = 0x8000;
+        report.pc.ly = 0x8000;
+        report.pc.rx = 0x8000;
+        report.pc.ry = 0x8000;
+      } else {
+        report.sw.buttons = 0;
+        report.sw.hat = OUTPUT_HAT_CENTERED;
+        report.sw.lx = 0x80;
+        report.sw.ly = 0x80;
+        report.sw.rx = 0x80;
+        report.sw.ry = 0x80;
+      }
     }
     
-    // Get current report (for debugging)
+    // Get current report (for debugging, Switch layout)
     ProControllerReport_t* getReport() {
-      return &report;
+      return &report.sw;
+    }
+
+    // Get current report (for debugging, PC layout)
+    ProControllerHiResReport_t* getHiResReport() {
+      return &report.pc;
     }
 };
 
+// Switch Pro 2 (Report 0x05) motion data offsets, per ndeadly's switch2_controller_research
+#define PRO2_ACCEL_OFFSET  0x30  // 3x int16 little-endian
+#define PRO2_GYRO_OFFSET   0x36  // 3x int16 little-endian
+#define PRO2_IMU_MIN_LEN   (PRO2_GYRO_OFFSET + 6)
+
+// Decoded Switch Pro 2 input (full resolution)
+typedef struct {
+  uint32_t timestamp_us;  // time_us_32() at decode, before shaping and the gamepad send
+  uint32_t buttons32;  // Raw Pro 2 button bits
+  uint16_t lx, ly;     // 12-bit sticks (0-4095)
+  uint16_t rx, ry;
+  int16_t accel[3];    // Zero when the report carries no motion data
+  int16_t gyro[3];
+  bool has_imu;
+} Pro2Input_t;
+
+// Stick calibration (12-bit counts): the first window of this many consecutive reports in
+// which no axis moves more than the jitter, averaging no further from 2048 than the offset
+// limit, sets the resting center; it stays frozen until the controller is unplugged
+#define STICK_CAL_WINDOW      32
+#define STICK_CAL_JITTER      24
+#define STICK_CAL_MAX_OFFSET  64
+
+// Resting stick offsets of one connected Pro 2
+typedef struct {
+  int16_t center[4];   // Offset from 2048 (lx, ly, rx, ry), valid once done
+  int16_t min[4];      // Current window
+  int16_t max[4];
+  int32_t sum[4];
+  uint8_t count;
+  bool done;
+} StickCal_t;
+
+// Input report decoders (values are stored in the device cache - append only)
+enum InputDecoder : uint8_t {
+  DECODER_UNKNOWN = 0,
+  DECODER_SWITCH_PRO2,   // Report 0x05, 16+ bytes
+  DECODER_SWITCH_PRO,    // Report 0x30, 12+ bytes
+  DECODER_GENERIC,       // 7+ bytes: buttons, hat, 4 axes
+};
+
 // HID Bridging Functions
+bool decodeSwitchPro2(const uint8_t* report, uint16_t len, Pro2Input_t* in);
 void forwardGenericGamepad(const uint8_t* report, uint16_t len, ProControllerOutput* output);
 void forwardSwitchPro(const uint8_t* report, uint16_t len, ProControllerOutput* output);
-void forwardSwitchPro2(const uint8_t* report, uint16_t len, ProControllerOutput* output);
+// cal (here and in forwardDecoded): optional per-connection calibration, learned from the
+// decoded reports until done, then subtracted before shaping
+void forwardSwitchPro2(const uint8_t* report, uint16_t len, ProControllerOutput* output,
+                       StickCal_t* cal = nullptr);
+uint8_t detectInputDecoder(const uint8_t* report, uint16_t len);
+void forwardDecoded(uint8_t decoder, const uint8_t* report, uint16_t len, ProControllerOutput* output,
+                    StickCal_t* cal = nullptr);
 void forwardHIDReport(const uint8_t* report, uint16_t len, ProControllerOutput* output);
@@ -0,0 +1,65 @@
+/************************************************************************
+Status LED - WS2812 on GPIO 16 driven by a PIO state machine fed by DMA
+Patterns loop in hardware; changing status is a single pointer write
+*************************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "hardware/pio.h"
+
+#define LED_PIN 16
+
+// PIO-USB host occupies pio0/pio1, the LED gets its own block
+#ifndef LED_PIO
+#define LED_PIO pio2
+#endif
+
+// Fixed DMA channels, clear of PIO-USB's channel 0
+#ifndef LED_DMA_DATA_CH
+#define LED_DMA_DATA_CH 10
+#endif
+#ifndef LED_DMA_CTRL_CH
+#define LED_DMA_CTRL_CH 11
+#endif
+
+// Gap between input reports that counts as a latency spike
+#define LED_LATENCY_WARN_US 20000
+
+#define LED_PATTERN_FRAMES 4
+#define LED_PATTERN_WORDS  (LED_PATTERN_FRAMES * 2)  // Color + hold count per frame
+
+enum LedStatus {
+  LED_BOOTING = 0,         // Red
+  LED_WAITING,             // Blue blink - no controller
+  LED_CONNECTED,           // Dim green
+  LED_PROFILE_CHANGED,     // White double flash
+  LED_LATENCY_WARNING,     // Amber blink
+  LED_STATUS_COUNT
+};
+
+class StatusLed {
+  private:
+    LedStatus base;                  // Steady status restored after a flash
+    volatile uint32_t flash_until;   // time_us_32() deadline, 0 = no flash active
+    uint sm;
+
+  public:
+    StatusLed() : base(LED_BOOTING), flash_until(0), sm(0) {}
+
+    // Claim the state machine and DMA channels, start the booting pattern
+    void begin();
+
+    // Switch the steady pattern (takes effect at the end of the current loop)
+    void set(LedStatus status);
+
+    // Show a transient pattern, reverted by poll()
+    void flash(LedStatus status, uint32_t duration_ms);
+
+    // Core0: restore the steady pattern once a flash has expired
+    void poll();
+
+    // Re-derive the bit timing after clk_sys changes
+    void retime();
+};
+
+extern StatusLed statusLed;
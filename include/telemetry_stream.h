@@ -0,0 +1,73 @@
+/************************************************************************
+Telemetry Stream - Vendor-defined HID IN endpoint mirroring decoded input
+One record per Pro 2 report for input displays and timing capture tools
+*************************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "Adafruit_TinyUSB.h"
+#include "pro_controller_output.h"
+
+#define TELEMETRY_VERSION      1
+#define TELEMETRY_REPORT_SIZE  36
+
+// Records waiting for the endpoint (oldest is dropped when full)
+#ifndef TELEMETRY_QUEUE_LEN
+#define TELEMETRY_QUEUE_LEN 8
+#endif
+
+// Record flags
+#define TELEMETRY_FLAG_IMU  0x01  // accel/gyro are valid
+
+// Vendor-defined HID Report Descriptor (one input report, no report ID)
+uint8_t const desc_hid_report_telemetry[] = {
+  0x06, 0x01, 0xFF,  // Usage Page (Vendor Defined 0xFF01)
+  0x09, 0x01,        // Usage (0x01)
+  0xA1, 0x01,        // Collection (Application)
+  0x15, 0x00,        //   Logical Minimum (0)
+  0x26, 0xFF, 0x00,  //   Logical Maximum (255)
+  0x75, 0x08,        //   Report Size (8)
+  0x95, TELEMETRY_REPORT_SIZE,  //   Report Count (36)
+  0x09, 0x02,        //   Usage (0x02)
+  0x81, 0x02,        //   Input (Data,Var,Abs)
+  0xC0,              // End Collection
+};
+
+// Telemetry record (one per decoded input report)
+typedef struct __attribute__((packed)) {
+  uint8_t version;         // TELEMETRY_VERSION
+  uint8_t flags;           // TELEMETRY_FLAG_*
+  uint16_t seq;            // Increments per decoded report - gaps are drops
+  uint32_t timestamp_us;   // time_us_32() at decode (Pro2Input_t)
+  uint32_t buttons32;      // Raw Pro 2 button bits
+  uint16_t lx, ly;         // 12-bit sticks as received (before deadzone/curve)
+  uint16_t rx, ry;
+  int16_t accel[3];
+  int16_t gyro[3];
+  uint32_t dropped;        // Records dropped so far
+} TelemetryReport_t;
+
+static_assert(sizeof(TelemetryReport_t) == TELEMETRY_REPORT_SIZE, "record must match the descriptor");
+
+class TelemetryStream {
+  private:
+    Adafruit_USBD_HID usb_hid;
+    TelemetryReport_t queue[TELEMETRY_QUEUE_LEN];
+    uint8_t head;      // Oldest queued record
+    uint8_t count;
+    uint16_t seq;
+
+  public:
+    TelemetryStream() : usb_hid(), head(0), count(0), seq(0) {}
+
+    // Add the interface - call before the gamepad waits for enumeration
+    void begin();
+
+    // Core1: queue a decoded report and send what the endpoint can take
+    void push(const Pro2Input_t* in);
+
+    // Core1: send the oldest queued record if the endpoint is free (never waits)
+    void flush();
+};
+
+extern TelemetryStream telemetryStream;
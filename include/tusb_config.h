@@ -27,8 +27,8 @@ extern "C" {
 // Disable CDC completely
 #define CFG_TUD_CDC              0
 
-// Enable HID only
-#define CFG_TUD_HID              1
+// Enable HID only (gamepad + vendor config interface + telemetry stream)
+#define CFG_TUD_HID              3
 
 //--------------------------------------------------------------------
 // HOST CONFIGURATION (for PIO USB HID)
@@ -0,0 +1,120 @@
+/************************************************************************
+Bridge Config Implementation
+Defaults, validation and the shadow block publish
+*************************************************************************/
+
+#include "bridge_config.h"
+#include "gyro_aim.h"
+#include <string.h>
+
+BridgeStats_t bridgeStats;
+ConfigStore configStore;
+
+// Default Pro 2 -> output button mapping (16+ only exist in the PC layout)
+static const uint8_t default_button_map[32] = {
+  OutButton_Y,          // Y
+  OutButton_X,          // X
+  OutButton_B,          // B
+  OutButton_A,          // A
+  OutButton_SR_Right,   // SR-Right
+  OutButton_SL_Right,   // SL-Right
+  OutButton_R,          // R
+  OutButton_ZR,         // ZR
+  OutButton_Minus,      // Minus
+  OutButton_Plus,       // Plus
+  OutButton_RightStick, // R-Stick
+  OutButton_LeftStick,  // L-Stick
+  OutButton_Home,       // Home
+  OutButton_Capture,    // Capture
+  OutButton_C,          // C
+  BRIDGE_BUTTON_NONE,
+  BRIDGE_BUTTON_NONE,   // Down (D-pad)
+  BRIDGE_BUTTON_NONE,   // Up (D-pad)
+  BRIDGE_BUTTON_NONE,   // Right (D-pad)
+  BRIDGE_BUTTON_NONE,   // Left (D-pad)
+  OutButton_SR_Left,    // SR-Left
+  OutButton_SL_Left,    // SL-Left
+  OutButton_L,          // L
+  OutButton_ZL,         // ZL
+  OutButton_GR,         // GR
+  OutButton_GL,         // GL
+  BRIDGE_BUTTON_NONE,
+  BRIDGE_BUTTON_NONE,
+  OutButton_Headset,    // Headset
+  BRIDGE_BUTTON_NONE,
+  BRIDGE_BUTTON_NONE,
+  BRIDGE_BUTTON_NONE,
+};
+
+void bridgeConfigDefaults(BridgeConfigData_t* data) {
+  memset(data, 0, sizeof(*data));
+  data->version = BRIDGE_CONFIG_VERSION;
+  data->flags = GYRO_AIM_ENABLED ? BRIDGE_FLAG_GYRO_AIM : 0;
+  data->output_mode = BRIDGE_OUTPUT_MODE;
+  data->output_interval_ms = BRIDGE_OUTPUT_MODE == BRIDGE_OUTPUT_PC_HIRES ? 1 : 4;
+  memcpy(data->button_map, default_button_map, sizeof(data->button_map));
+
+  // Linear response, no deadzone
+  data->stick_deadzone = 0;
+  for (uint8_t i = 0; i < BRIDGE_CURVE_POINTS; i++) {
+    data->stick_curve[i] = i * (BRIDGE_CURVE_MAX / (BRIDGE_CURVE_POINTS - 1));
+  }
+
+  data->gyro_sensitivity = GYRO_AIM_SENSITIVITY;
+  data->gyro_deadband = GYRO_AIM_DEADBAND;
+  data->gyro_ratchet_bit = __builtin_ctz(GYRO_AIM_RATCHET_MASK);
+}
+
+bool bridgeConfigValid(const BridgeConfigData_t* data) {
+  if (data->version != BRIDGE_CONFIG_VERSION) return false;
+  if (data->output_interval_ms < 1 || data->output_interval_ms > 16) return false;
+  if (data->output_mode > BRIDGE_OUTPUT_PC_HIRES) return false;
+  if (data->stick_deadzone >= BRIDGE_STICK_MAX) return false;
+  if (data->gyro_ratchet_bit >= 32 && data->gyro_ratchet_bit != BRIDGE_BUTTON_NONE) return false;
+
+  for (uint8_t i = 0; i < 32; i++) {
+    if (data->button_map[i] >= 32 && data->button_map[i] != BRIDGE_BUTTON_NONE) return false;
+  }
+
+  // Curve must be monotonic and within the half-range
+  for (uint8_t i = 0; i < BRIDGE_CURVE_POINTS; i++) {
+    if (data->stick_curve[i] > BRIDGE_CURVE_MAX) return false;
+    if (i > 0 && data->stick_curve[i] < data->stick_curve[i - 1]) return false;
+  }
+  return true;
+}
+
+// Precompute hot path values for a block about to be published
+static void compileConfig(BridgeConfig_t* cfg) {
+  cfg->deadzone_scale = ((uint32_t)BRIDGE_STICK_MAX << 16) / (BRIDGE_STICK_MAX - cfg->data.stick_deadzone);
+  cfg->ratchet_mask = cfg->data.gyro_ratchet_bit < 32 ? (1UL << cfg->data.gyro_ratchet_bit) : 0;
+}
+
+ConfigStore::ConfigStore() : active(&blocks[0]), reader_epoch(0), retire_epoch(0), generation(0) {
+  bridgeConfigDefaults(&blocks[0].data);
+  compileConfig(&blocks[0]);
+  blocks[1] = blocks[0];
+}
+
+bool ConfigStore::publish(const BridgeConfigData_t* data) {
+  if (!bridgeConfigValid(data)) return false;
+
+  const BridgeConfig_t* current = active.load(std::memory_order_relaxed);
+  BridgeConfig_t* shadow = (current == &blocks[0]) ? &blocks[1] : &blocks[0];
+
+  // Shadow was the active block before the last swap - wait for core1 to pass a quiescent point
+  if (generation > 0 && reader_epoch.load(std::memory_order_acquire) == retire_epoch) {
+    return false;
+  }
+
+  shadow->data = *data;
+  compileConfig(shadow);
+
+  active.store(shadow, std::memory_order_release);
+  // Store-then-load on both cores: without a full barrier the M33 may read the epoch
+  // before the new pointer is visible, and a block core1 still holds would look retired
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  retire_epoch = reader_epoch.load(std::memory_order_acquire);
+  generation++;
+  return true;
+}
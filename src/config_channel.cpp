@@ -0,0 +1,146 @@
+/************************************************************************
+Config Channel Implementation
+Runs in tud_task() on core0; core1 only ever sees published configs
+*************************************************************************/
+
+#include "config_channel.h"
+#include "gyro_aim.h"
+#include "status_led.h"
+#include "device_cache.h"
+#include "pico/platform.h"
+
+// Time left for the host to finish the SET_REPORT (and read back) before re-enumerating
+#define CONFIG_REENUMERATE_DELAY_MS 100
+
+// Config carried across the reboot that re-enumerates the gamepad (survives a watchdog reset)
+#define CONFIG_RETAINED_MAGIC 0x50524F32  // "PRO2"
+static BridgeConfigData_t __uninitialized_ram(retained_config);
+static uint32_t __uninitialized_ram(retained_magic);
+
+static volatile uint32_t reenumerate_at = 0;  // millis() of the pending reboot, 0 = none
+
+// Config written by the host, waiting for core1 to pass a quiescent point (core0 only)
+static BridgeConfigData_t staged_config;
+static bool staged = false;
+
+ConfigChannel configChannel;
+
+static uint16_t config_get_report(uint8_t report_id, hid_report_type_t report_type,
+                                  uint8_t* buffer, uint16_t reqlen) {
+  if (report_type != HID_REPORT_TYPE_FEATURE || reqlen < BRIDGE_REPORT_SIZE) return 0;
+  memset(buffer, 0, BRIDGE_REPORT_SIZE);
+
+  if (report_id == BRIDGE_CONFIG_REPORT_ID) {
+    memcpy(buffer, &configStore.read()->data, sizeof(BridgeConfigData_t));
+    return BRIDGE_REPORT_SIZE;
+  }
+
+  if (report_id == BRIDGE_DIAG_REPORT_ID) {
+    BridgeDiag_t diag;
+    memset(&diag, 0, sizeof(diag));
+    diag.version = BRIDGE_CONFIG_VERSION;
+    diag.reports_in = bridgeStats.reports_in;
+    diag.reports_sent = bridgeStats.reports_sent;
+    diag.send_busy = bridgeStats.send_busy;
+    diag.config_generation = configStore.getGeneration();
+    diag.gyro_max_cycles = gyroAim.maxCycles();
+    diag.gyro_over_budget = gyroAim.overBudget();
+    diag.taps_rescued = bridgeStats.taps_rescued;
+    diag.telemetry_dropped = bridgeStats.telemetry_dropped;
+    diag.attach_to_report_us = bridgeStats.attach_to_report_us;
+    diag.cache_hits = bridgeStats.cache_hits;
+    memcpy(buffer, &diag, sizeof(diag));
+    return BRIDGE_REPORT_SIZE;
+  }
+
+  return 0;
+}
+
+static void config_set_report(uint8_t report_id, hid_report_type_t report_type,
+                              uint8_t const* buffer, uint16_t bufsize) {
+  if (report_type != HID_REPORT_TYPE_FEATURE || report_id != BRIDGE_CONFIG_REPORT_ID) return;
+
+  // Some stacks leave the report ID in front of the payload
+  if (bufsize > BRIDGE_REPORT_SIZE && buffer[0] == report_id) {
+    buffer++;
+    bufsize--;
+  }
+  if (bufsize < sizeof(BridgeConfigData_t)) return;
+
+  BridgeConfigData_t data;
+  memcpy(&data, buffer, sizeof(data));
+  if (!bridgeConfigValid(&data)) return;
+
+  // Published from poll() - tud_task() never waits on core1 (a newer config replaces it)
+  staged_config = data;
+  staged = true;
+}
+
+// Core0: act on a config that was just published
+static void config_published(const BridgeConfigData_t* data, bool reenumerate) {
+  statusLed.flash(LED_PROFILE_CHANGED, 400);
+
+  if (data->diag_flags & BRIDGE_DIAG_RESET_STATS) {
+    bridgeStats.reports_in = 0;
+    bridgeStats.reports_sent = 0;
+    bridgeStats.send_busy = 0;
+    bridgeStats.taps_rescued = 0;
+    bridgeStats.telemetry_dropped = 0;
+    bridgeStats.cache_hits = 0;
+  }
+
+  if (data->diag_flags & BRIDGE_DIAG_CLEAR_DEVICE_CACHE) {
+    deviceCache.clear();
+  }
+
+  if (reenumerate) {
+    retained_config = *data;
+    retained_config.diag_flags &= ~(BRIDGE_DIAG_RESET_STATS | BRIDGE_DIAG_CLEAR_DEVICE_CACHE);
+    reenumerate_at = (millis() + CONFIG_REENUMERATE_DELAY_MS) | 1;  // Never 0 while pending
+  }
+}
+
+void ConfigChannel::restore() {
+  // Back from a re-enumeration reboot - restore the config that asked for it
+  if (retained_magic == CONFIG_RETAINED_MAGIC) {
+    retained_magic = 0;
+    configStore.publish(&retained_config);
+    return;
+  }
+
+  // Power-up - enumerate with the output mode/interval last set over the channel
+  BridgeConfigData_t data = configStore.read()->data;
+  if (deviceCache.storedOutput(&data.output_mode, &data.output_interval_ms)) {
+    configStore.publish(&data);  // An invalid stored value leaves the build defaults
+  }
+}
+
+void ConfigChannel::begin() {
+  usb_hid.setPollInterval(10);
+  usb_hid.setReportDescriptor(desc_hid_report_config, sizeof(desc_hid_report_config));
+  usb_hid.setReportCallback(config_get_report, config_set_report);
+  usb_hid.begin();
+}
+
+void ConfigChannel::poll() {
+  // Retried every loop until core1 has left the shadow block (it does so every tuh_task loop);
+  // the host sees config_generation change in the diag report once it is live
+  if (staged) {
+    // Output mode and interval are part of the descriptors - they need a fresh enumeration
+    const BridgeConfigData_t* current = &configStore.read()->data;
+    bool reenumerate = staged_config.output_mode != current->output_mode ||
+                       staged_config.output_interval_ms != current->output_interval_ms;
+    if (configStore.publish(&staged_config)) {
+      staged = false;
+      config_published(&staged_config, reenumerate);
+    }
+  }
+
+  uint32_t at = reenumerate_at;
+  if (at && (int32_t)(millis() - at) >= 0) {
+    // Keep the new descriptors for power-up too (core1 is parked while flash is written)
+    deviceCache.storeOutput(retained_config.output_mode, retained_config.output_interval_ms);
+    retained_magic = CONFIG_RETAINED_MAGIC;
+    rp2040.reboot();
+  }
+}
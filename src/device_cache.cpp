@@ -0,0 +1,235 @@
+/************************************************************************
+Device Cache Implementation
+Report IDs live in RAM and are written to flash (EEPROM emulation) from
+core0 only while the host port is empty, with core1 parked in SRAM;
+the stored output mode is written just before its re-enumeration reboot
+*************************************************************************/
+
+#include "device_cache.h"
+#include <stddef.h>
+#include "bridge_config.h"
+#include "power_idle.h"
+#include "hot_path.h"
+#include <EEPROM.h>
+#include "hardware/sync.h"
+#include "tusb.h"
+
+// How long core0 waits for core1 to park before retrying at the next poll
+#define DEVICE_CACHE_PARK_TIMEOUT_US  10000
+
+DeviceCache deviceCache;
+
+// Core1 park handshake for flash writes
+static volatile bool park_request = false;
+static volatile bool core1_parked = false;
+
+// FNV-1a, chained through hash
+static uint32_t fnv1a(uint32_t hash, const void* data, uint32_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (len--) {
+    hash ^= *p++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+#define FNV1A_SEED 2166136261u
+
+static uint32_t imageCrc(const DeviceCacheImage_t* img) {
+  return fnv1a(FNV1A_SEED, img, offsetof(DeviceCacheImage_t, crc));
+}
+
+// Same controller interface
+static bool sameInterface(const DeviceProfile_t* a, const DeviceProfile_t* b) {
+  return a->vid == b->vid && a->pid == b->pid && a->instance == b->instance &&
+         a->desc_hash == b->desc_hash;
+}
+
+DeviceCache::DeviceCache() : dirty(false), clear_requested(false) {
+  memset(&image, 0, sizeof(image));
+  memset(routes, 0, sizeof(routes));
+}
+
+void DeviceCache::begin() {
+  EEPROM.begin(sizeof(image));
+  EEPROM.get(0, image);
+
+  // Blank or stale flash - start empty (nothing to write until a profile is stored)
+  if (image.magic != DEVICE_CACHE_MAGIC || image.version != DEVICE_CACHE_VERSION ||
+      image.crc != imageCrc(&image)) {
+    memset(&image, 0, sizeof(image));
+    image.magic = DEVICE_CACHE_MAGIC;
+    image.version = DEVICE_CACHE_VERSION;
+  }
+}
+
+InputRoute_t* HOT_PATH(DeviceCache::findRoute)(uint8_t dev_addr, uint8_t instance) {
+  for (uint8_t i = 0; i < DEVICE_CACHE_ROUTES; i++) {
+    if (routes[i].dev_addr == dev_addr && routes[i].instance == instance) return &routes[i];
+  }
+  return nullptr;
+}
+
+// Most recently stored profile for this interface
+const DeviceProfile_t* DeviceCache::lookup(const DeviceProfile_t* key) const {
+  const DeviceProfile_t* best = nullptr;
+  for (uint8_t i = 0; i < DEVICE_CACHE_ENTRIES; i++) {
+    const DeviceProfile_t* e = &image.entries[i];
+    if (e->decoder == DECODER_UNKNOWN || !sameInterface(e, key)) continue;
+    if (!best || e->stamp > best->stamp) best = e;
+  }
+  return best;
+}
+
+// Write a profile into the image: over its own entry, or the oldest one
+void DeviceCache::store(const DeviceProfile_t* p) {
+  DeviceProfile_t* slot = nullptr;
+  for (uint8_t i = 0; i < DEVICE_CACHE_ENTRIES && !slot; i++) {
+    DeviceProfile_t* e = &image.entries[i];
+    if (e->decoder != DECODER_UNKNOWN && sameInterface(e, p)) slot = e;
+  }
+  if (!slot) {
+    slot = &image.entries[0];
+    for (uint8_t i = 1; i < DEVICE_CACHE_ENTRIES; i++) {
+      DeviceProfile_t* e = &image.entries[i];
+      if (slot->decoder == DECODER_UNKNOWN) break;
+      if (e->decoder == DECODER_UNKNOWN || e->stamp < slot->stamp) slot = e;
+    }
+  }
+
+  // Unchanged - leave the flash alone
+  DeviceProfile_t updated = *p;
+  updated.stamp = slot->stamp;
+  if (memcmp(slot, &updated, sizeof(updated)) == 0) return;
+
+  updated.stamp = ++image.stamp;
+  *slot = updated;
+  dirty = true;
+}
+
+void DeviceCache::mount(uint8_t dev_addr, uint8_t instance, const uint8_t* desc_report, uint16_t desc_len) {
+  InputRoute_t* r = findRoute(0, 0);
+  if (!r) return;  // More instances than routes - those use plain detection
+
+  memset(r, 0, sizeof(*r));
+  r->dev_addr = dev_addr;
+  r->instance = instance;
+  uint16_t vid = 0, pid = 0;
+  tuh_vid_pid_get(dev_addr, &vid, &pid);
+  r->profile.vid = vid;
+  r->profile.pid = pid;
+  r->profile.instance = instance;
+  r->profile.desc_hash = fnv1a(FNV1A_SEED, desc_report, desc_len);
+
+  // Known model - its input report ID filters from the first report
+  const DeviceProfile_t* hit = lookup(&r->profile);
+  if (hit) {
+    r->profile = *hit;
+    bridgeStats.cache_hits++;
+  }
+}
+
+void DeviceCache::unmount(uint8_t dev_addr, uint8_t instance) {
+  InputRoute_t* r = findRoute(dev_addr, instance);
+  if (r) memset(r, 0, sizeof(*r));
+}
+
+void HOT_PATH(DeviceCache::forward)(uint8_t dev_addr, uint8_t instance, const uint8_t* report,
+                                    uint16_t len, ProControllerOutput* output) {
+  if (!report || len == 0) return;
+
+  InputRoute_t* r = findRoute(dev_addr, instance);
+  if (!r) {
+    forwardHIDReport(report, len, output);
+    return;
+  }
+
+  // Known stream: other report IDs (subcommand replies, status) are not input state
+  if (r->profile.report_id && report[0] != r->profile.report_id) return;
+
+  uint8_t decoder = r->profile.decoder;
+  if (decoder == DECODER_UNKNOWN) {
+    // Detected per report as without the cache; a Pro 2 / Pro input ID is unambiguous,
+    // so it is kept for this connection and stored for the next one
+    decoder = detectInputDecoder(report, len);
+    if (decoder == DECODER_SWITCH_PRO2 || decoder == DECODER_SWITCH_PRO) {
+      r->profile.decoder = decoder;
+      r->profile.report_id = report[0];
+      store(&r->profile);
+    }
+  }
+
+  forwardDecoded(decoder, report, len, output, &r->cal);
+}
+
+bool HOT_PATH(DeviceCache::streaming)(uint8_t dev_addr, uint8_t instance) {
+  InputRoute_t* r = findRoute(dev_addr, instance);
+  if (!r) return false;
+  return r->profile.decoder == DECODER_SWITCH_PRO2 || r->profile.decoder == DECODER_SWITCH_PRO;
+}
+
+void __not_in_flash_func(DeviceCache::core1Park)() {
+  if (!park_request) return;
+
+  // Nothing may fetch from flash (XIP) or take an interrupt while it is erased
+  uint32_t save = save_and_disable_interrupts();
+  __dmb();
+  core1_parked = true;
+  __sev();
+  while (park_request) __wfe();
+  core1_parked = false;
+  restore_interrupts(save);
+}
+
+bool DeviceCache::storedOutput(uint8_t* mode, uint8_t* interval_ms) const {
+  if (image.output_interval_ms == 0) return false;
+  *mode = image.output_mode;
+  *interval_ms = image.output_interval_ms;
+  return true;
+}
+
+void DeviceCache::storeOutput(uint8_t mode, uint8_t interval_ms) {
+  if (image.output_mode != mode || image.output_interval_ms != interval_ms) {
+    image.output_mode = mode;
+    image.output_interval_ms = interval_ms;
+    dirty = true;
+  }
+  write(false);
+}
+
+void DeviceCache::poll() {
+  if (!powerIdle.portEmpty()) return;
+  write(true);
+}
+
+// Core0: park core1 and write the image if anything changed
+void DeviceCache::write(bool port_empty_only) {
+  if (!dirty && !clear_requested) return;
+
+  // core1 runs its own loop (not setup1/loop1), so EEPROM.commit() cannot idle it
+  park_request = true;
+  __sev();
+  uint32_t start = time_us_32();
+  while (!core1_parked) {
+    if (time_us_32() - start > DEVICE_CACHE_PARK_TIMEOUT_US) {
+      park_request = false;
+      return;
+    }
+  }
+
+  // Re-check with core1 stopped: nothing attached while it was parking
+  if (!port_empty_only || powerIdle.portEmpty()) {
+    if (clear_requested) {
+      memset(image.entries, 0, sizeof(image.entries));
+      image.stamp = 0;
+      clear_requested = false;
+    }
+    image.crc = imageCrc(&image);
+    EEPROM.put(0, image);
+    EEPROM.commit();
+    dirty = false;
+  }
+
+  park_request = false;
+  __sev();
+}
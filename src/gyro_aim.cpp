@@ -0,0 +1,69 @@
+/************************************************************************
+Gyro Aim Implementation
+Maps averaged gyro rate over each output window onto the right stick
+*************************************************************************/
+
+#include "gyro_aim.h"
+#include "hot_path.h"
+#include "cycle_counter.h"
+
+#if defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#define GYRO_SSAT16(v) __ssat((v), 16)
+#define GYRO_USAT12(v) __usat((v), 12)
+#else
+static inline int32_t GYRO_SSAT16(int32_t v) { return v > 32767 ? 32767 : (v < -32768 ? -32768 : v); }
+static inline int32_t GYRO_USAT12(int32_t v) { return v > 4095 ? 4095 : (v < 0 ? 0 : v); }
+#endif
+
+// Window length cap - keeps sum * sensitivity inside 32 bits if sends stall
+#define GYRO_AIM_MAX_SAMPLES 64
+
+GyroAim gyroAim;
+
+// Remove the deadband from a raw gyro sample
+static inline int32_t gyroDeadband(int32_t v, int32_t deadband) {
+  if (v > deadband) return v - deadband;
+  if (v < -deadband) return v + deadband;
+  return 0;
+}
+
+void HOT_PATH(GyroAim::apply)(const BridgeConfig_t* cfg, const int16_t gyro[3], uint32_t buttons32,
+                    uint16_t* rx, uint16_t* ry) {
+  uint32_t start = cycleCount();
+  int32_t deadband = cfg->data.gyro_deadband;
+  int32_t sensitivity = cfg->data.gyro_sensitivity;
+
+  if (buttons32 & cfg->ratchet_mask) {
+    // Ratchet held - drop motion so releasing it resumes from the physical stick
+    sum_x = sum_y = 0;
+    samples = 0;
+    frac_x = frac_y = 0;
+    pend_frac_x = pend_frac_y = 0;
+  } else {
+    if (samples >= GYRO_AIM_MAX_SAMPLES) {
+      sum_x >>= 1;
+      sum_y >>= 1;
+      samples >>= 1;
+    }
+    sum_x += gyroDeadband(gyro[GYRO_AIM_AXIS_X], deadband);
+    sum_y += gyroDeadband(gyro[GYRO_AIM_AXIS_Y], deadband);
+    samples++;
+
+    // Average rate over the window in Q8 stick units, plus last window's remainder
+    int32_t qx = GYRO_SSAT16(sum_x / samples) * sensitivity + frac_x;
+    int32_t qy = GYRO_SSAT16(sum_y / samples) * sensitivity + frac_y;
+    int32_t dx = qx >> 8;
+    int32_t dy = qy >> 8;
+    pend_frac_x = qx - (dx << 8);
+    pend_frac_y = qy - (dy << 8);
+
+    // Pitch up moves the stick up (HID Y grows downward)
+    *rx = GYRO_USAT12((int32_t)*rx + dx);
+    *ry = GYRO_USAT12((int32_t)*ry - dy);
+  }
+
+  uint32_t cycles = cycleCount() - start;
+  if (cycles > max_cycles) max_cycles = cycles;
+  if (cycles > GYRO_AIM_CYCLE_BUDGET) over_budget++;
+}
@@ -0,0 +1,211 @@
+/************************************************************************
+Keyboard & Mouse Translator Implementation
+Keys map to buttons/D-pad/left stick, mouse buttons to triggers and
+mouse motion to the right stick through a per-window accumulator
+*************************************************************************/
+
+#include "kbm_translator.h"
+#include "hot_path.h"
+
+KbmTranslator kbmTranslator;
+
+// Keyboard usage -> output button
+typedef struct {
+  uint8_t usage;
+  uint8_t button;
+} KbmKeyMap_t;
+
+// Not const: searched on every keyboard report, so it lives in RAM rather than XIP
+static KbmKeyMap_t kbm_key_map[] = {
+  { 0x2C, OutButton_B },             // Space
+  { 0x08, OutButton_A },             // E
+  { 0x15, OutButton_X },             // R
+  { 0x09, OutButton_Y },             // F
+  { 0x14, OutButton_L },             // Q
+  { 0x06, OutButton_R },             // C
+  { 0x19, OutButton_RightStick },    // V
+  { 0x28, OutButton_Plus },          // Enter
+  { 0x2A, OutButton_Minus },         // Backspace
+  { 0x29, OutButton_Home },          // Escape
+  { 0x45, OutButton_Capture },       // F12
+};
+
+#define KBM_MOD_LSHIFT  0x02  // Left Shift -> L-Stick click
+
+// Keyboard usages for movement
+#define KBM_KEY_W      0x1A
+#define KBM_KEY_A      0x04
+#define KBM_KEY_S      0x16
+#define KBM_KEY_D      0x07
+#define KBM_KEY_RIGHT  0x4F
+#define KBM_KEY_LEFT   0x50
+#define KBM_KEY_DOWN   0x51
+#define KBM_KEY_UP     0x52
+
+// D-pad direction from four arrow states (opposites cancel)
+static uint8_t HOT_PATH(hatFromArrows)(bool up, bool down, bool left, bool right) {
+  if (up && down) up = down = false;
+  if (left && right) left = right = false;
+  if (up && right) return OUTPUT_HAT_UP_RIGHT;
+  if (down && right) return OUTPUT_HAT_DOWN_RIGHT;
+  if (down && left) return OUTPUT_HAT_DOWN_LEFT;
+  if (up && left) return OUTPUT_HAT_UP_LEFT;
+  if (up) return OUTPUT_HAT_UP;
+  if (right) return OUTPUT_HAT_RIGHT;
+  if (down) return OUTPUT_HAT_DOWN;
+  if (left) return OUTPUT_HAT_LEFT;
+  return OUTPUT_HAT_CENTERED;
+}
+
+// Stick deflection per mouse count over a window, Q16. Computed once per window
+// so the per-axis math is a multiply and a 32-bit divide (no libgcc 64-bit divide).
+static_assert((uint64_t)KBM_MOUSE_GAIN * 256000 <= UINT32_MAX, "KBM_MOUSE_GAIN too large for the Q16 stick scale");
+static inline uint32_t HOT_PATH(stickScale)(uint32_t window_us) {
+  return (uint32_t)KBM_MOUSE_GAIN * 256000 / window_us;
+}
+
+// Stick deflection (-127..127) for counts at a window's scale, and the counts it represents.
+// Whatever the deflection cannot carry (saturation, sub-unit remainder) stays accumulated.
+static int32_t HOT_PATH(stickFromCounts)(int32_t counts, uint32_t scale, int32_t* consumed) {
+  uint32_t mag = counts < 0 ? 0u - (uint32_t)counts : (uint32_t)counts;
+  uint32_t product;
+  uint32_t defl = __builtin_umul_overflow(mag, scale, &product) ? 127 : product >> 16;
+  if (defl > 127) defl = 127;
+  int32_t carried = (int32_t)((defl << 16) / scale);
+  *consumed = counts < 0 ? -carried : carried;
+  return counts < 0 ? -(int32_t)defl : (int32_t)defl;
+}
+
+void KbmTranslator::reset() {
+  key_buttons = 0;
+  mouse_buttons = 0;
+  dpad = OUTPUT_HAT_CENTERED;
+  lx = ly = 0x80;
+  acc_x = acc_y = 0;
+  pend_x = pend_y = 0;
+  window_start_us = time_us_32();
+  last_motion_us = 0;
+  stick_active = false;
+  dirty = false;
+}
+
+// Velocity window ending now. After a pause the last send can be seconds ago,
+// so it never spans more than one output interval (motion onset shows at once).
+static uint32_t HOT_PATH(velocityWindow)(uint32_t since, uint32_t now) {
+  uint32_t window = now - since;
+  uint32_t max_window = configStore.read()->data.output_interval_ms * 1000;
+  if (window > max_window) window = max_window;
+  if (window < KBM_MIN_WINDOW_US) window = KBM_MIN_WINDOW_US;
+  return window;
+}
+
+bool HOT_PATH(KbmTranslator::send)(ProControllerOutput* output, uint32_t now) {
+  uint32_t scale = stickScale(velocityWindow(window_start_us, now));
+
+  int32_t rx = stickFromCounts(acc_x, scale, &pend_x);
+  int32_t ry = stickFromCounts(acc_y, scale, &pend_y);
+
+  output->setButtons(key_buttons | mouse_buttons);
+  output->setDPad(dpad);
+  output->setLeftStick(lx, ly);
+  output->setRightStick(0x80 + rx, 0x80 + ry);
+  if (!output->sendReport()) return false;
+
+  // Sent - the next window starts with whatever this report could not carry
+  acc_x -= pend_x;
+  acc_y -= pend_y;
+  window_start_us = now;
+  dirty = false;
+  return true;
+}
+
+void HOT_PATH(KbmTranslator::keyboardReport)(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
+  if (len < 8 || !output) return;
+
+  uint16_t buttons = 0;
+  bool w = false, a = false, s = false, d = false;
+  bool up = false, down = false, left = false, right = false;
+
+  if (report[0] & KBM_MOD_LSHIFT) buttons |= (1 << OutButton_LeftStick);
+
+  for (uint8_t i = 2; i < 8; i++) {
+    uint8_t usage = report[i];
+    if (usage == 0) continue;
+
+    switch (usage) {
+      case KBM_KEY_W: w = true; break;
+      case KBM_KEY_A: a = true; break;
+      case KBM_KEY_S: s = true; break;
+      case KBM_KEY_D: d = true; break;
+      case KBM_KEY_UP: up = true; break;
+      case KBM_KEY_DOWN: down = true; break;
+      case KBM_KEY_LEFT: left = true; break;
+      case KBM_KEY_RIGHT: right = true; break;
+      default:
+        for (uint8_t k = 0; k < sizeof(kbm_key_map) / sizeof(kbm_key_map[0]); k++) {
+          if (kbm_key_map[k].usage == usage) {
+            buttons |= (1 << kbm_key_map[k].button);
+            break;
+          }
+        }
+        break;
+    }
+  }
+
+  key_buttons = buttons;
+  dpad = hatFromArrows(up, down, left, right);
+  lx = a == d ? 0x80 : (a ? 0x00 : 0xFF);
+  ly = w == s ? 0x80 : (w ? 0x00 : 0xFF);
+  dirty = true;
+
+  send(output, time_us_32());
+}
+
+void HOT_PATH(KbmTranslator::mouseReport)(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
+  if (len < 3 || !output) return;
+
+  uint16_t buttons = 0;
+  if (report[0] & 0x01) buttons |= (1 << OutButton_ZR);          // Left -> ZR
+  if (report[0] & 0x02) buttons |= (1 << OutButton_ZL);          // Right -> ZL
+  if (report[0] & 0x04) buttons |= (1 << OutButton_RightStick);  // Middle -> R-Stick
+  if (buttons != mouse_buttons) dirty = true;
+  mouse_buttons = buttons;
+
+  // Integrate every report; the next sent report carries the whole window
+  int8_t dx = (int8_t)report[1];
+  int8_t dy = (int8_t)report[2];
+  uint32_t now = time_us_32();
+  if (dx || dy) {
+    acc_x += dx;
+    acc_y += dy;
+    last_motion_us = now;
+    stick_active = true;
+    dirty = true;
+  }
+
+  send(output, now);
+}
+
+void HOT_PATH(KbmTranslator::idle)(ProControllerOutput* output) {
+  if ((!dirty && !stick_active) || !output->ready()) return;
+
+  uint32_t now = time_us_32();
+  bool drained = false;
+  if (stick_active && now - last_motion_us >= KBM_MOUSE_IDLE_US) {
+    // Mouse stopped - keep sending until saturated motion is delivered,
+    // then drop the sub-unit remainder and recenter
+    uint32_t scale = stickScale(velocityWindow(window_start_us, now));
+    int32_t unused;
+    drained = stickFromCounts(acc_x, scale, &unused) == 0 &&
+              stickFromCounts(acc_y, scale, &unused) == 0;
+    if (drained) {
+      acc_x = acc_y = 0;
+    }
+  } else if (!dirty) {
+    return;
+  }
+
+  if (send(output, now) && drained) {
+    stick_active = false;
+  }
+}
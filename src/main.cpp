@@ -1,21 +1,23 @@
 #include <Arduino.h>
 #include "tusb.h"
-#include <Adafruit_NeoPixel.h>
 #include "pio_usb.h"
 #include <pico/multicore.h>
 #include "hid_report_parser.h"
 #include "pro_controller_output.h"
+#include "gyro_aim.h"
+#include "bridge_config.h"
+#include "config_channel.h"
+#include "status_led.h"
+#include "kbm_translator.h"
+#include "telemetry_stream.h"
+#include "hot_path.h"
+#include "power_idle.h"
+#include "device_cache.h"
+#include "cycle_counter.h"
 
 // Debug output disabled (production mode - low latency)
 #define DEBUG_SERIAL 0
 
-#define LED_PIN 16
-#define NUM_LEDS 1
-#define BLINK_COLOR 0x00FF00  // Green
-#define BLINK_MS 50
-
-Adafruit_NeoPixel strip(NUM_LEDS, LED_PIN, NEO_GRB + NEO_KHZ800);
-
 // Pro Controller Output (on native USB)
 ProControllerOutput proController;
 
@@ -23,9 +25,14 @@ ProControllerOutput proController;
 static uint8_t prev_report[4][64] = {0};  // Support up to 4 HID instances
 static uint16_t prev_report_len[4] = {0};
 
-// Core1: USB Host task
-void core1_main() {
+// Mounted HID instances (drives the LED status) and last report time per instance
+static volatile uint8_t hid_mounted = 0;
+static uint32_t last_report_us[4] = {0};
+
+// Core1: USB Host task (the loop is on the hot path)
+void HOT_PATH(core1_main)() {
   delay(100);  // Let core0 initialize serial first
+  cycleCounterBegin();  // This core's DWT times GyroAim::apply
   
   // Initialize Pico-PIO-USB for host mode on core1
   pio_usb_configuration_t pio_cfg = PIO_USB_DEFAULT_CONFIG;
@@ -36,18 +43,20 @@ void core1_main() {
   tuh_init(1);
   
   while (true) {
+    powerIdle.poll();  // Sleeps at reduced clock while the host port is empty
     tuh_task();  // Run USB host task continuously on core1
+    configStore.quiescent();  // No config pointer held between tasks
+    kbmTranslator.idle(&proController);
+    proController.service();  // Tap releases and core0's keepalive
+    telemetryStream.flush();
+    deviceCache.core1Park();  // Holds here (in SRAM) while core0 writes the cache to flash
   }
 }
 
 void setup() {
-  // Blink LED to show we're starting
-  strip.begin();
-  strip.setPixelColor(0, 0xFF0000);  // Red = starting
-  strip.show();
-  delay(500);
-  strip.setPixelColor(0, 0);
-  strip.show();
+  // Status LED runs from PIO + DMA (red = starting)
+  statusLed.begin();
+  powerIdle.begin();
 
 #if DEBUG_SERIAL
   // Initialize Serial for debugging
@@ -58,12 +67,20 @@ void setup() {
   Serial.println("GPIO 12/13: Waiting for input controller...\n");
 #endif
   
-  // Initialize Pro Controller output on native USB
+  // Config that picks the output mode (stored in flash with the device cache)
+  deviceCache.begin();
+  configChannel.restore();
+
+  // Gamepad interface first so it is the first HID interface, as on a stock HORIPAD;
+  // the vendor config and telemetry interfaces follow before the host enumerates
   proController.begin();
+  configChannel.begin();
+  telemetryStream.begin();
+  proController.waitMounted();
   
   delay(2000);  // Wait for USB enumeration
   
-  // Send initial report to register the gamepad
+  // Send initial report to register the gamepad (core1 is not running yet)
   proController.sendReport();
 
 #if DEBUG_SERIAL
@@ -73,6 +90,8 @@ void setup() {
   // Launch USB host task on core1
   multicore_launch_core1(core1_main);
   delay(200);
+
+  statusLed.set(LED_WAITING);
 }
 
 void loop() {
@@ -82,9 +101,13 @@ void loop() {
   // Send periodic report to keep gamepad active
   static uint32_t last_report = 0;
   if (millis() - last_report >= 100) {  // Every 100ms
-    proController.sendReport();
+    proController.requestKeepalive();  // Sent by core1 - only core1 touches the report
     last_report = millis();
   }
+
+  statusLed.poll();
+  configChannel.poll();
+  deviceCache.poll();
   
   delay(1);
 }
@@ -113,6 +136,8 @@ void tuh_mount_cb(uint8_t dev_addr) {
 #endif
     tuh_hid_receive_report(dev_addr, idx);
   }
+
+  powerIdle.deviceMounted();
 }
 
 // Called when any device is unmounted
@@ -120,6 +145,7 @@ void tuh_umount_cb(uint8_t dev_addr) {
 #if DEBUG_SERIAL
   Serial.printf("\n<<< Device Disconnected\n");
 #endif
+  powerIdle.deviceUnmounted();
   (void)dev_addr;
 }
 
@@ -130,8 +156,15 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance,
   Serial.printf("HID device mounted: addr=%u, inst=%u, report_len=%u\n",
                 dev_addr, instance, desc_len);
 #endif
-  (void)desc_report;
-  (void)desc_len;
+  // Controllers start with their stored report ID filter (keyboard/mouse go to the translator)
+  uint8_t const protocol = tuh_hid_interface_protocol(dev_addr, instance);
+  if (protocol != HID_ITF_PROTOCOL_KEYBOARD && protocol != HID_ITF_PROTOCOL_MOUSE) {
+    deviceCache.mount(dev_addr, instance, desc_report, desc_len);
+  }
+
+  hid_mounted++;
+  statusLed.set(LED_CONNECTED);
+  if (instance < 4) last_report_us[instance] = 0;
 
   if (!tuh_hid_receive_report(dev_addr, instance)) {
 #if DEBUG_SERIAL
@@ -143,12 +176,29 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance,
 void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
 #if DEBUG_SERIAL
   Serial.printf("HID device unmounted: addr=%u, inst=%u\n", dev_addr, instance);
+  Serial.printf("Gyro aim: max %lu cycles, %lu over budget\n",
+                (unsigned long)gyroAim.maxCycles(), (unsigned long)gyroAim.overBudget());
+  Serial.printf("Taps rescued: %lu\n", (unsigned long)bridgeStats.taps_rescued);
 #endif
+  gyroAim.reset();
+  deviceCache.unmount(dev_addr, instance);
+  uint8_t const protocol = tuh_hid_interface_protocol(dev_addr, instance);
+  if (protocol == HID_ITF_PROTOCOL_KEYBOARD || protocol == HID_ITF_PROTOCOL_MOUSE) {
+    kbmTranslator.reset();
+  }
+
+  // Release whatever the unplugged input held - the keepalive would keep resending it
+  proController.reset();
+  proController.requestKeepalive();  // Sent by service() as soon as the endpoint is free
+
+  if (hid_mounted > 0 && --hid_mounted == 0) {
+    statusLed.set(LED_WAITING);
+  }
   (void)dev_addr;
   (void)instance;
 }
 
-void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance,
+void HOT_PATH(tuh_hid_report_received_cb)(uint8_t dev_addr, uint8_t instance,
                                 uint8_t const* report, uint16_t len) {
 #if DEBUG_SERIAL
   // Check if this report is identical to the previous one (debug only)
@@ -186,21 +236,34 @@ void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance,
     Serial.print(" ");
   }
   Serial.println();
-  
-  // Blink WS2812B on HID report received (debug only)
-  strip.setPixelColor(0, BLINK_COLOR);  // Turn LED on
-  strip.show();
-  delay(BLINK_MS);
-  strip.setPixelColor(0, 0);           // Turn LED off
-  strip.show();
 #else
   // Production mode - no debug overhead
   (void)dev_addr;
   (void)instance;
 #endif
 
+  powerIdle.reportReceived();
+
+  // Flag gaps between reports (stalled host or PIO-USB retries) - only from controllers
+  // that stream at a fixed rate; keyboards, mice and generic pads report on change
+  if (instance < 4) {
+    uint32_t now = time_us_32();
+    if (last_report_us[instance] && now - last_report_us[instance] > LED_LATENCY_WARN_US &&
+        deviceCache.streaming(dev_addr, instance)) {
+      statusLed.flash(LED_LATENCY_WARNING, 1000);
+    }
+    last_report_us[instance] = now;
+  }
+
   // Forward input HID report to output gamepad (ALWAYS)
-  forwardHIDReport(report, len, &proController);
+  uint8_t const protocol = tuh_hid_interface_protocol(dev_addr, instance);
+  if (protocol == HID_ITF_PROTOCOL_KEYBOARD) {
+    kbmTranslator.keyboardReport(report, len, &proController);
+  } else if (protocol == HID_ITF_PROTOCOL_MOUSE) {
+    kbmTranslator.mouseReport(report, len, &proController);
+  } else {
+    deviceCache.forward(dev_addr, instance, report, len, &proController);
+  }
 
   // Request next report
   if (!tuh_hid_receive_report(dev_addr, instance)) {
@@ -0,0 +1,82 @@
+/************************************************************************
+Power Idle Implementation
+PIO-USB is bit-timed for a 120 MHz clk_sys, so the idle clock is only
+used while the port is empty; line state is polled from GPIO and does
+not depend on the PIO timing
+*************************************************************************/
+
+#include "power_idle.h"
+#include "status_led.h"
+#include "hardware/clocks.h"
+#include "pico/stdlib.h"
+#include "tusb.h"
+#include "host/hcd.h"
+#include "hot_path.h"
+
+// Root hub port handed to tuh_init() on core1
+#define POWER_IDLE_RHPORT 1
+
+PowerIdle powerIdle;
+
+// TinyUSB host event posted (attach, transfer done) - wake core1 wherever the ISR ran
+void HOT_PATH(tuh_event_hook_cb)(uint8_t rhport, uint32_t eventid, bool in_isr) {
+  (void)rhport;
+  (void)eventid;
+  (void)in_isr;
+  __sev();
+}
+
+void PowerIdle::begin() {
+  // ADC, HSTX and UART/SPI (clk_peri) are unused
+  clock_stop(clk_adc);
+  clock_stop(clk_peri);
+#if PICO_RP2350
+  clock_stop(clk_hstx);
+#endif
+}
+
+void PowerIdle::setSpeed(bool low) {
+  if (low) {
+    set_sys_clock_48mhz();  // clk_sys from pll_usb, pll_sys stopped
+  } else {
+    set_sys_clock_khz(F_CPU / 1000, true);
+  }
+  clock_stop(clk_peri);     // Both calls re-source clk_peri
+  statusLed.retime();
+  slow = low;
+}
+
+void PowerIdle::sawAttach() {
+  if (!connected) {
+    attach_us = time_us_32() | 1;  // Never 0 while pending
+  }
+  connected = true;
+  last_connected_ms = millis();
+}
+
+void HOT_PATH(PowerIdle::poll)() {
+  if (hcd_port_connect_status(POWER_IDLE_RHPORT)) {
+    sawAttach();
+  } else {
+    connected = false;
+  }
+
+  bool idle = !connected && devices == 0 && millis() - last_connected_ms >= POWER_IDLE_HOLDOFF_MS;
+  if (!idle) {
+    if (slow) setSpeed(false);
+    return;
+  }
+
+#if POWER_IDLE_ENABLED
+  if (!slow) setSpeed(true);
+
+  // Sleep until a host event, an interrupt on this core or the timeout
+  best_effort_wfe_or_timeout(make_timeout_time_us(POWER_IDLE_WAKE_US));
+
+  // Device attached while asleep - full speed before tuh_task() resets the bus
+  if (hcd_port_connect_status(POWER_IDLE_RHPORT)) {
+    sawAttach();
+    setSpeed(false);
+  }
+#endif
+}
@@ -4,9 +4,97 @@ Handles HID bridging from input controllers to output gamepad
 *************************************************************************/
 
 #include "pro_controller_output.h"
+#include "gyro_aim.h"
+#include "bridge_config.h"
+#include "telemetry_stream.h"
+#include "hot_path.h"
+
+bool HOT_PATH(ProControllerOutput::sendReport)() {
+  // Taps ride along in the live report for this send only (TinyUSB copies it into the
+  // endpoint buffer), so no report copy is made with or without taps
+  bool sent;
+  uint32_t taps;
+  if (hires) {
+    taps = latched & ~report.pc.buttons;
+    report.pc.buttons |= taps;
+    sent = usb_hid.sendReport(0, &report.pc, sizeof(report.pc));
+    report.pc.buttons &= ~taps;
+  } else {
+    taps = (uint16_t)latched & ~report.sw.buttons;
+    report.sw.buttons |= taps;
+    sent = usb_hid.sendReport(0, &report.sw, sizeof(report.sw));
+    report.sw.buttons &= ~taps;
+  }
+  if (sent) {
+    rescued(taps);
+    keepalive_pending = false;
+    bridgeStats.reports_sent++;
+  } else {
+    bridgeStats.send_busy++;
+  }
+  return sent;
+}
+
+void HOT_PATH(ProControllerOutput::service)() {
+  if ((release_pending || keepalive_pending) && usb_hid.ready()) {
+    sendReport();
+  }
+}
+
+// Apply the configured deadzone and response curve to one 12-bit axis
+static inline uint16_t HOT_PATH(shapeAxis)(const BridgeConfig_t* cfg, uint16_t v) {
+  int32_t d = (int32_t)v - 2048;
+  uint32_t a = d < 0 ? -d : d;
+  if (a <= cfg->data.stick_deadzone) return 2048;
+
+  // Stretch the remaining travel back to full range, then interpolate the curve
+  a = ((a - cfg->data.stick_deadzone) * cfg->deadzone_scale) >> 16;
+  if (a > BRIDGE_STICK_MAX) a = BRIDGE_STICK_MAX;
+  uint32_t seg = a >> 8;
+  int32_t lo = cfg->data.stick_curve[seg];
+  int32_t hi = cfg->data.stick_curve[seg + 1];
+  a = lo + (((hi - lo) * (int32_t)(a & 0xFF)) >> 8);
+
+  if (d < 0) return 2048 - a;
+  return a > BRIDGE_STICK_MAX ? 4095 : 2048 + a;
+}
+
+// Remove a learned resting offset from one 12-bit axis
+static inline uint16_t HOT_PATH(recenterAxis)(uint16_t v, int16_t center) {
+  int32_t r = (int32_t)v - center;
+  return r < 0 ? 0 : (r > 4095 ? 4095 : r);
+}
+
+// Feed one decoded report into the calibration - done after the first still, centered window
+static void HOT_PATH(stickCalFeed)(StickCal_t* cal, const Pro2Input_t* in) {
+  int16_t d[4] = { (int16_t)(in->lx - 2048), (int16_t)(in->ly - 2048),
+                   (int16_t)(in->rx - 2048), (int16_t)(in->ry - 2048) };
+  for (uint8_t i = 0; i < 4; i++) {
+    if (cal->count == 0) {
+      cal->min[i] = cal->max[i] = d[i];
+      cal->sum[i] = 0;
+    }
+    if (d[i] < cal->min[i]) cal->min[i] = d[i];
+    if (d[i] > cal->max[i]) cal->max[i] = d[i];
+    if (cal->max[i] - cal->min[i] > STICK_CAL_JITTER) {
+      cal->count = 0;  // Moving - start a new window
+      return;
+    }
+    cal->sum[i] += d[i];
+  }
+  if (++cal->count < STICK_CAL_WINDOW) return;
+  cal->count = 0;
+
+  for (uint8_t i = 0; i < 4; i++) {
+    int32_t mean = cal->sum[i] / STICK_CAL_WINDOW;
+    if (mean > STICK_CAL_MAX_OFFSET || mean < -STICK_CAL_MAX_OFFSET) return;  // Held, not rest
+  }
+  for (uint8_t i = 0; i < 4; i++) cal->center[i] = cal->sum[i] / STICK_CAL_WINDOW;
+  cal->done = true;
+}
 
 // Forward generic gamepad report (7+ bytes) to output
-void forwardGenericGamepad(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
+void HOT_PATH(forwardGenericGamepad)(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
   if (len >= 7 && output) {
     // Standard gamepad format: 2 bytes buttons, 1 byte hat, 4 bytes axes
     uint16_t buttons = report[0] | (report[1] << 8);
@@ -25,83 +113,161 @@ void forwardGenericGamepad(const uint8_t* report, uint16_t len, ProControllerOut
 }
 
 // Forward Switch Pro Controller (Report 0x30) to output
-void forwardSwitchPro(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
+void HOT_PATH(forwardSwitchPro)(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
   if (len >= 12 && report[0] == 0x30 && output) {
     // Switch Pro Controller standard input report
     uint16_t buttons = report[1] | (report[2] << 8);
     uint8_t dpad = report[3] & 0x0F;
     
-    // Extract 12-bit stick values and convert to 8-bit (0-4095 -> 0-255)
+    // Extract 12-bit stick values
     uint16_t lx = report[4] | ((report[5] & 0x0F) << 8);
     uint16_t ly = (report[5] >> 4) | (report[6] << 4);
     uint16_t rx = report[7] | ((report[8] & 0x0F) << 8);
     uint16_t ry = (report[8] >> 4) | (report[9] << 4);
     
+    const BridgeConfig_t* cfg = configStore.read();
+    lx = shapeAxis(cfg, lx);
+    ly = shapeAxis(cfg, ly);
+    rx = shapeAxis(cfg, rx);
+    ry = shapeAxis(cfg, ry);
+    
     output->setButtons(buttons);
     output->setDPad(dpad);
-    output->setLeftStick(lx >> 4, ly >> 4);   // Scale 12-bit to 8-bit
-    output->setRightStick(rx >> 4, ry >> 4);
+    output->setLeftStick12(lx, ly);   // Scaled to the output layout
+    output->setRightStick12(rx, ry);
     output->sendReport();
   }
 }
 
+// Decode Switch Pro 2 Controller (Report 0x05) at full resolution
+bool HOT_PATH(decodeSwitchPro2)(const uint8_t* report, uint16_t len, Pro2Input_t* in) {
+  if (len < 16 || report[0] != 0x05 || !in) return false;
+  in->timestamp_us = time_us_32();
+
+  // Switch Pro 2 format - buttons at offset 4
+  in->buttons32 = report[4] | (report[5] << 8) | (report[6] << 16) | ((uint32_t)report[7] << 24);
+
+  // 12-bit stick values, 3 bytes per stick
+  in->lx = report[10] | ((report[11] & 0x0F) << 8);
+  in->ly = (report[11] >> 4) | (report[12] << 4);
+  in->rx = report[13] | ((report[14] & 0x0F) << 8);
+  in->ry = (report[14] >> 4) | (report[15] << 4);
+
+  // Motion data (accelerometer then gyro)
+  in->has_imu = len >= PRO2_IMU_MIN_LEN;
+  for (uint8_t i = 0; i < 3; i++) {
+    if (in->has_imu) {
+      in->accel[i] = (int16_t)(report[PRO2_ACCEL_OFFSET + 2 * i] | (report[PRO2_ACCEL_OFFSET + 2 * i + 1] << 8));
+      in->gyro[i] = (int16_t)(report[PRO2_GYRO_OFFSET + 2 * i] | (report[PRO2_GYRO_OFFSET + 2 * i + 1] << 8));
+    } else {
+      in->accel[i] = 0;
+      in->gyro[i] = 0;
+    }
+  }
+  return true;
+}
+
 // Forward Switch Pro 2 Controller (Report 0x05) to output
-void forwardSwitchPro2(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
-  if (len >= 16 && report[0] == 0x05 && output) {
-    // Switch Pro 2 format - buttons at offset 4
-    uint32_t buttons32 = report[4] | (report[5] << 8) | (report[6] << 16) | (report[7] << 24);
+void HOT_PATH(forwardSwitchPro2)(const uint8_t* report, uint16_t len, ProControllerOutput* output,
+                                 StickCal_t* cal) {
+  Pro2Input_t in;
+  if (output && decodeSwitchPro2(report, len, &in)) {
+    // Resting center: learned once per connection, never moved during play
+    const int16_t* center = nullptr;
+    if (cal) {
+      if (!cal->done) stickCalFeed(cal, &in);
+      if (cal->done) center = cal->center;
+    }
+
+    uint32_t buttons32 = in.buttons32;
+    const BridgeConfig_t* cfg = configStore.read();
     
-    // Map Pro 2 buttons to standard 16-bit button layout
-    uint16_t buttons = 0;
-    if (buttons32 & 0x00000001) buttons |= (1 << 0);  // Y
-    if (buttons32 & 0x00000002) buttons |= (1 << 1);  // X
-    if (buttons32 & 0x00000004) buttons |= (1 << 2);  // B
-    if (buttons32 & 0x00000008) buttons |= (1 << 3);  // A
-    if (buttons32 & 0x00000040) buttons |= (1 << 4);  // R
-    if (buttons32 & 0x00000080) buttons |= (1 << 5);  // ZR
-    if (buttons32 & 0x00000100) buttons |= (1 << 6);  // Minus
-    if (buttons32 & 0x00000200) buttons |= (1 << 7);  // Plus
-    if (buttons32 & 0x00000400) buttons |= (1 << 8);  // R-Stick
-    if (buttons32 & 0x00000800) buttons |= (1 << 9);  // L-Stick
-    if (buttons32 & 0x00001000) buttons |= (1 << 10); // Home
-    if (buttons32 & 0x00002000) buttons |= (1 << 11); // Capture
-    if (buttons32 & 0x00400000) buttons |= (1 << 12); // L
-    if (buttons32 & 0x00800000) buttons |= (1 << 13); // ZL
+    // Map Pro 2 buttons through the configured table
+    uint32_t buttons = 0;
+    uint32_t bits = buttons32;
+    while (bits) {
+      uint8_t i = __builtin_ctz(bits);
+      bits &= bits - 1;
+      if (cfg->data.button_map[i] != BRIDGE_BUTTON_NONE) {
+        buttons |= (1UL << cfg->data.button_map[i]);
+      }
+    }
     
     // D-pad from byte 2
-    uint8_t dpad = 0x08; // Centered
-    if (buttons32 & 0x00020000) dpad = 0; // Up
-    if (buttons32 & 0x00010000) dpad = 4; // Down
-    if (buttons32 & 0x00080000) dpad = 6; // Left
-    if (buttons32 & 0x00040000) dpad = 2; // Right
-    
-    // Extract 12-bit stick values and convert to 8-bit
-    uint16_t lx = report[10] | ((report[11] & 0x0F) << 8);
-    uint16_t ly = (report[11] >> 4) | (report[12] << 4);
-    uint16_t rx = report[13] | ((report[14] & 0x0F) << 8);
-    uint16_t ry = (report[14] >> 4) | (report[15] << 4);
+    uint8_t dpad = OUTPUT_HAT_CENTERED;
+    if (buttons32 & 0x00020000) dpad = OUTPUT_HAT_UP;
+    if (buttons32 & 0x00010000) dpad = OUTPUT_HAT_DOWN;
+    if (buttons32 & 0x00080000) dpad = OUTPUT_HAT_LEFT;
+    if (buttons32 & 0x00040000) dpad = OUTPUT_HAT_RIGHT;
+
+    // Shaped copies - the decoded input stays raw for telemetry
+    uint16_t lx = in.lx, ly = in.ly, rx = in.rx, ry = in.ry;
+    if (center) {
+      lx = recenterAxis(lx, center[0]);
+      ly = recenterAxis(ly, center[1]);
+      rx = recenterAxis(rx, center[2]);
+      ry = recenterAxis(ry, center[3]);
+    }
+    lx = shapeAxis(cfg, lx);
+    ly = shapeAxis(cfg, ly);
+    rx = shapeAxis(cfg, rx);
+    ry = shapeAxis(cfg, ry);
+
+    // Gyro aim adds onto the shaped right stick before output scaling
+    bool gyro_on = in.has_imu && (cfg->data.flags & BRIDGE_FLAG_GYRO_AIM);
+    if (gyro_on) {
+      gyroAim.apply(cfg, in.gyro, buttons32, &rx, &ry);
+    }
     
+    // 12-bit sticks go straight into the output layout (8-bit or 16-bit)
     output->setButtons(buttons);
     output->setDPad(dpad);
-    output->setLeftStick(lx >> 4, ly >> 4);
-    output->setRightStick(rx >> 4, ry >> 4);
-    output->sendReport();
+    output->setLeftStick12(lx, ly);
+    output->setRightStick12(rx, ry);
+    if (output->sendReport() && gyro_on) {
+      gyroAim.commit();
+    }
+
+    // Mirror the raw decode after the gamepad report is on its way
+    telemetryStream.push(&in);
   }
 }
 
-// Auto-detect and forward any HID report
-void forwardHIDReport(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
-  if (!report || !output || len == 0) return;
-  
-  // Detect report type by size and report ID
+// Pick the decoder for a report by size and report ID
+uint8_t HOT_PATH(detectInputDecoder)(const uint8_t* report, uint16_t len) {
   if (len >= 16 && report[0] == 0x05) {
-    // Switch Pro 2 Controller
-    forwardSwitchPro2(report, len, output);
+    return DECODER_SWITCH_PRO2;
   } else if (len >= 12 && report[0] == 0x30) {
-    // Switch Pro Controller
-    forwardSwitchPro(report, len, output);
+    return DECODER_SWITCH_PRO;
   } else if (len >= 7) {
-    // Generic gamepad
-    forwardGenericGamepad(report, len, output);
+    return DECODER_GENERIC;
+  }
+  return DECODER_UNKNOWN;
+}
+
+// Forward a report with an already resolved decoder
+void HOT_PATH(forwardDecoded)(uint8_t decoder, const uint8_t* report, uint16_t len,
+                              ProControllerOutput* output, StickCal_t* cal) {
+  if (!report || !output || len == 0) return;
+  bridgeStats.reports_in++;
+
+  switch (decoder) {
+    case DECODER_SWITCH_PRO2:
+      forwardSwitchPro2(report, len, output, cal);
+      break;
+    case DECODER_SWITCH_PRO:
+      forwardSwitchPro(report, len, output);
+      break;
+    case DECODER_GENERIC:
+      forwardGenericGamepad(report, len, output);
+      break;
+    default:
+      break;
   }
 }
+
+// Auto-detect and forward any HID report
+void HOT_PATH(forwardHIDReport)(const uint8_t* report, uint16_t len, ProControllerOutput* output) {
+  if (!report || !output || len == 0) return;
+  forwardDecoded(detectInputDecoder(report, len), report, len, output);
+}
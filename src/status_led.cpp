@@ -0,0 +1,147 @@
+/************************************************************************
+Status LED Implementation
+A data DMA channel streams (color, hold) pairs into the PIO TX FIFO and
+chains to a control channel that re-triggers it from pattern_addr, so
+patterns repeat forever without touching either core.
+*************************************************************************/
+
+#include "status_led.h"
+#include "hot_path.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+
+// WS2812 program with a hold loop after each pixel
+//   .side_set 1
+//   .wrap_target
+//       pull block          side 0        ; color (GRB in bits 31..8)
+//       set x, 23           side 0
+//   bitloop:
+//       out y, 1            side 0 [3]
+//       jmp !y do_zero      side 1 [2]
+//       jmp x-- bitloop     side 1 [2]    ; '1' bit
+//       jmp hold            side 0
+//   do_zero:
+//       jmp x-- bitloop     side 0 [2]    ; '0' bit
+//   hold:
+//       pull block          side 0        ; hold count
+//       mov y, osr          side 0
+//   holdloop:
+//       jmp y-- holdloop    side 0 [15]   ; 16 cycles = 2us per count
+//   .wrap
+static const uint16_t status_led_program_instructions[] = {
+  0x80a0,  //  0: pull   block           side 0
+  0xe037,  //  1: set    x, 23           side 0
+  0x6341,  //  2: out    y, 1            side 0 [3]
+  0x1266,  //  3: jmp    !y, 6           side 1 [2]
+  0x1242,  //  4: jmp    x--, 2          side 1 [2]
+  0x0007,  //  5: jmp    7               side 0
+  0x0242,  //  6: jmp    x--, 2          side 0 [2]
+  0x80a0,  //  7: pull   block           side 0
+  0xa047,  //  8: mov    y, osr          side 0
+  0x0f89,  //  9: jmp    y--, 9          side 0 [15]
+};
+
+static const pio_program_t status_led_program = {
+  .instructions = status_led_program_instructions,
+  .length = 10,
+  .origin = -1,
+#if PICO_PIO_VERSION > 0
+  .pio_version = 0,
+  .used_gpio_ranges = 0x0,
+#endif
+};
+
+#define LED_SM_HZ       8000000   // 10 cycles per bit = 800 kHz
+#define LED_HOLD(ms)    ((ms) * 500)
+#define LED_GRB(r, g, b) (((uint32_t)(g) << 24) | ((uint32_t)(r) << 16) | ((uint32_t)(b) << 8))
+
+#define LED_OFF    LED_GRB(0x00, 0x00, 0x00)
+#define LED_RED    LED_GRB(0x40, 0x00, 0x00)
+#define LED_BLUE   LED_GRB(0x00, 0x00, 0x40)
+#define LED_GREEN  LED_GRB(0x00, 0x10, 0x00)
+#define LED_WHITE  LED_GRB(0x30, 0x30, 0x30)
+#define LED_AMBER  LED_GRB(0x40, 0x18, 0x00)
+
+// Patterns live in RAM so the DMA never waits on XIP
+static uint32_t led_patterns[LED_STATUS_COUNT][LED_PATTERN_WORDS] __attribute__((aligned(4))) = {
+  // LED_BOOTING
+  { LED_RED, LED_HOLD(50), LED_RED, LED_HOLD(50), LED_RED, LED_HOLD(50), LED_RED, LED_HOLD(50) },
+  // LED_WAITING
+  { LED_BLUE, LED_HOLD(100), LED_OFF, LED_HOLD(100), LED_OFF, LED_HOLD(100), LED_OFF, LED_HOLD(100) },
+  // LED_CONNECTED
+  { LED_GREEN, LED_HOLD(50), LED_GREEN, LED_HOLD(50), LED_GREEN, LED_HOLD(50), LED_GREEN, LED_HOLD(50) },
+  // LED_PROFILE_CHANGED
+  { LED_WHITE, LED_HOLD(50), LED_OFF, LED_HOLD(50), LED_WHITE, LED_HOLD(50), LED_OFF, LED_HOLD(50) },
+  // LED_LATENCY_WARNING
+  { LED_AMBER, LED_HOLD(50), LED_OFF, LED_HOLD(50), LED_AMBER, LED_HOLD(50), LED_OFF, LED_HOLD(50) },
+};
+
+// Read by the control DMA channel at the end of every pattern loop
+static const uint32_t* volatile pattern_addr = led_patterns[LED_BOOTING];
+
+StatusLed statusLed;
+
+void StatusLed::begin() {
+  PIO pio = LED_PIO;
+  sm = pio_claim_unused_sm(pio, true);
+  uint offset = pio_add_program(pio, &status_led_program);
+
+  pio_gpio_init(pio, LED_PIN);
+  pio_sm_set_consecutive_pindirs(pio, sm, LED_PIN, 1, true);
+
+  pio_sm_config c = pio_get_default_sm_config();
+  sm_config_set_wrap(&c, offset, offset + status_led_program.length - 1);
+  sm_config_set_sideset(&c, 1, false, false);
+  sm_config_set_sideset_pins(&c, LED_PIN);
+  sm_config_set_out_shift(&c, false, false, 32);
+  sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+  sm_config_set_clkdiv(&c, (float)clock_get_hz(clk_sys) / LED_SM_HZ);
+  pio_sm_init(pio, sm, offset, &c);
+  pio_sm_set_enabled(pio, sm, true);
+
+  dma_channel_claim(LED_DMA_DATA_CH);
+  dma_channel_claim(LED_DMA_CTRL_CH);
+
+  // Data channel: pattern words -> PIO TX FIFO, then hand over to the control channel
+  dma_channel_config dc = dma_channel_get_default_config(LED_DMA_DATA_CH);
+  channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+  channel_config_set_read_increment(&dc, true);
+  channel_config_set_write_increment(&dc, false);
+  channel_config_set_dreq(&dc, pio_get_dreq(pio, sm, true));
+  channel_config_set_chain_to(&dc, LED_DMA_CTRL_CH);
+  dma_channel_configure(LED_DMA_DATA_CH, &dc, &pio->txf[sm], NULL, LED_PATTERN_WORDS, false);
+
+  // Control channel: reload the data channel's read address and trigger it
+  dma_channel_config cc = dma_channel_get_default_config(LED_DMA_CTRL_CH);
+  channel_config_set_transfer_data_size(&cc, DMA_SIZE_32);
+  channel_config_set_read_increment(&cc, false);
+  channel_config_set_write_increment(&cc, false);
+  dma_channel_configure(LED_DMA_CTRL_CH, &cc, &dma_hw->ch[LED_DMA_DATA_CH].al3_read_addr_trig,
+                        &pattern_addr, 1, true);
+}
+
+void StatusLed::retime() {
+  pio_sm_set_clkdiv(LED_PIO, sm, (float)clock_get_hz(clk_sys) / LED_SM_HZ);
+}
+
+void StatusLed::set(LedStatus status) {
+  base = status;
+  if (!flash_until) {
+    pattern_addr = led_patterns[status];
+  }
+}
+
+// Called from the input report callback on a latency spike - time_us_32() is
+// an inline timer read where millis() would be a call into flash
+void HOT_PATH(StatusLed::flash)(LedStatus status, uint32_t duration_ms) {
+  pattern_addr = led_patterns[status];
+  flash_until = (time_us_32() + duration_ms * 1000) | 1;  // Never 0 while active
+}
+
+void StatusLed::poll() {
+  uint32_t until = flash_until;
+  if (until && (int32_t)(time_us_32() - until) >= 0) {
+    flash_until = 0;
+    pattern_addr = led_patterns[base];
+  }
+}
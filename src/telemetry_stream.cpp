@@ -0,0 +1,54 @@
+/************************************************************************
+Telemetry Stream Implementation
+Only core1 touches the queue; a busy or unread endpoint costs one
+ready() check per report and never holds up the gamepad
+*************************************************************************/
+
+#include "telemetry_stream.h"
+#include "hot_path.h"
+
+TelemetryStream telemetryStream;
+
+void TelemetryStream::begin() {
+  usb_hid.setPollInterval(1);
+  usb_hid.setReportDescriptor(desc_hid_report_telemetry, sizeof(desc_hid_report_telemetry));
+  usb_hid.begin();
+}
+
+void HOT_PATH(TelemetryStream::push)(const Pro2Input_t* in) {
+  if (count == TELEMETRY_QUEUE_LEN) {
+    // Reader is behind - drop the oldest record
+    head = (head + 1) % TELEMETRY_QUEUE_LEN;
+    count--;
+    bridgeStats.telemetry_dropped++;
+  }
+
+  TelemetryReport_t* rec = &queue[(head + count) % TELEMETRY_QUEUE_LEN];
+  rec->version = TELEMETRY_VERSION;
+  rec->flags = in->has_imu ? TELEMETRY_FLAG_IMU : 0;
+  rec->seq = seq++;
+  rec->timestamp_us = in->timestamp_us;
+  rec->buttons32 = in->buttons32;
+  rec->lx = in->lx;
+  rec->ly = in->ly;
+  rec->rx = in->rx;
+  rec->ry = in->ry;
+  for (uint8_t i = 0; i < 3; i++) {
+    rec->accel[i] = in->accel[i];
+    rec->gyro[i] = in->gyro[i];
+  }
+  count++;
+
+  flush();
+}
+
+void HOT_PATH(TelemetryStream::flush)() {
+  if (count == 0 || !usb_hid.ready()) return;
+
+  TelemetryReport_t* rec = &queue[head];
+  rec->dropped = bridgeStats.telemetry_dropped;
+  if (usb_hid.sendReport(0, rec, sizeof(*rec))) {
+    head = (head + 1) % TELEMETRY_QUEUE_LEN;
+    count--;
+  }
+}
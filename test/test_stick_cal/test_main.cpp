@@ -0,0 +1,73 @@
+/************************************************************************
+Stick calibration tests - resting center learned once per connection
+Run: pio test -e native_test
+*************************************************************************/
+
+#include <unity.h>
+#include "pro_controller_output.h"
+
+static ProControllerOutput output;
+static StickCal_t cal;
+
+// Pro 2 report (0x05) with the left stick X at lx, everything else centered
+static void pro2Report(uint8_t* r, uint16_t lx) {
+  const uint16_t ly = 2048, rx = 2048, ry = 2048;
+  memset(r, 0, 64);
+  r[0] = 0x05;
+  r[10] = lx & 0xFF;
+  r[11] = ((lx >> 8) | (ly << 4)) & 0xFF;
+  r[12] = ly >> 4;
+  r[13] = rx & 0xFF;
+  r[14] = ((rx >> 8) | (ry << 4)) & 0xFF;
+  r[15] = ry >> 4;
+}
+
+// count reports at lx, alternating +-noise
+static void feed(int count, uint16_t lx, int noise) {
+  uint8_t r[64];
+  for (int i = 0; i < count; i++) {
+    pro2Report(r, lx + (i % 2 ? noise : -noise));
+    forwardSwitchPro2(r, sizeof(r), &output, &cal);
+  }
+}
+
+void setUp() {
+  memset(&cal, 0, sizeof(cal));
+  output.reset();
+}
+
+void tearDown() {}
+
+// A still stick near center sets the center after one window
+static void test_rest_window_sets_center() {
+  feed(STICK_CAL_WINDOW - 1, 2048 + 22, 0);
+  TEST_ASSERT_FALSE(cal.done);
+  feed(1, 2048 + 22, 0);
+  TEST_ASSERT_TRUE(cal.done);
+  TEST_ASSERT_EQUAL_INT16(22, cal.center[0]);
+  TEST_ASSERT_EQUAL_INT16(0, cal.center[1]);
+}
+
+// A thumb resting off center or a moving stick is not a center
+static void test_offset_and_jitter_rejected() {
+  feed(10 * STICK_CAL_WINDOW, 2048 + STICK_CAL_MAX_OFFSET + 40, 0);
+  TEST_ASSERT_FALSE(cal.done);
+  feed(10 * STICK_CAL_WINDOW, 2048, STICK_CAL_JITTER);
+  TEST_ASSERT_FALSE(cal.done);
+}
+
+// Aim held steady during play never moves the learned center
+static void test_center_frozen_after_learning() {
+  feed(STICK_CAL_WINDOW, 2048 + 10, 0);
+  TEST_ASSERT_TRUE(cal.done);
+  feed(50 * STICK_CAL_WINDOW, 2048 + 50, 0);
+  TEST_ASSERT_EQUAL_INT16(10, cal.center[0]);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rest_window_sets_center);
+  RUN_TEST(test_offset_and_jitter_rejected);
+  RUN_TEST(test_center_frozen_after_learning);
+  return UNITY_END();
+}
@@ -0,0 +1,114 @@
+/************************************************************************
+Tap latch tests - press/release between two output reports
+Run: pio test -e native_test
+*************************************************************************/
+
+#include <unity.h>
+#include "pro_controller_output.h"
+
+#define BUTTON_A  0x0001  // Any two output bits
+#define BUTTON_B  0x0002
+
+static ProControllerOutput output;
+
+// Buttons of the last report that reached the (shim) endpoint, Switch layout
+static uint16_t sentButtons() {
+  ProControllerReport_t r;
+  memcpy(&r, shim_hid_last, sizeof(r));
+  return r.buttons;
+}
+
+void setUp() {
+  shim_hid_busy = false;
+  shim_hid_sent = 0;
+  bridgeStats.taps_rescued = 0;
+  output.reset();
+}
+
+void tearDown() {}
+
+// Pressed and released before a send: held in one report, released in the next
+static void test_tap_held_then_released() {
+  output.setButtons(BUTTON_A);
+  output.setButtons(0);
+
+  TEST_ASSERT_TRUE(output.sendReport());
+  TEST_ASSERT_EQUAL_HEX16(BUTTON_A, sentButtons());
+  TEST_ASSERT_EQUAL_UINT32(1, bridgeStats.taps_rescued);
+
+  // No new input: the release still goes out at the next free endpoint
+  output.service();
+  TEST_ASSERT_EQUAL_UINT32(2, shim_hid_sent);
+  TEST_ASSERT_EQUAL_HEX16(0, sentButtons());
+
+  // Nothing left to send
+  output.service();
+  TEST_ASSERT_EQUAL_UINT32(2, shim_hid_sent);
+}
+
+// Release waits while the endpoint is busy, and is not sent twice
+static void test_release_waits_for_endpoint() {
+  output.setButtons(BUTTON_A);
+  output.setButtons(0);
+  TEST_ASSERT_TRUE(output.sendReport());
+
+  shim_hid_busy = true;
+  output.service();
+  TEST_ASSERT_EQUAL_UINT32(1, shim_hid_sent);
+
+  shim_hid_busy = false;
+  output.service();
+  output.service();
+  TEST_ASSERT_EQUAL_UINT32(2, shim_hid_sent);
+  TEST_ASSERT_EQUAL_HEX16(0, sentButtons());
+}
+
+// A tap during a busy endpoint survives the failed send
+static void test_tap_survives_busy_send() {
+  shim_hid_busy = true;
+  output.setButtons(BUTTON_B);
+  output.setButtons(0);
+  TEST_ASSERT_FALSE(output.sendReport());
+
+  shim_hid_busy = false;
+  TEST_ASSERT_TRUE(output.sendReport());
+  TEST_ASSERT_EQUAL_HEX16(BUTTON_B, sentButtons());
+  TEST_ASSERT_EQUAL_UINT32(1, bridgeStats.taps_rescued);
+}
+
+// A held button is current state, not a rescued tap, and needs no release
+static void test_held_button_not_rescued() {
+  output.setButtons(BUTTON_A);
+  TEST_ASSERT_TRUE(output.sendReport());
+  TEST_ASSERT_TRUE(output.sendReport());
+  TEST_ASSERT_EQUAL_HEX16(BUTTON_A, sentButtons());
+  TEST_ASSERT_EQUAL_UINT32(0, bridgeStats.taps_rescued);
+
+  output.service();
+  TEST_ASSERT_EQUAL_UINT32(2, shim_hid_sent);
+}
+
+// The keepalive resends the live state without touching it
+static void test_keepalive_sends_live_state() {
+  output.setButtons(BUTTON_A);
+  TEST_ASSERT_TRUE(output.sendReport());
+
+  output.setButtons(BUTTON_A | BUTTON_B);
+  output.requestKeepalive();
+  output.service();
+  TEST_ASSERT_EQUAL_UINT32(2, shim_hid_sent);
+  TEST_ASSERT_EQUAL_HEX16(BUTTON_A | BUTTON_B, sentButtons());
+
+  output.service();
+  TEST_ASSERT_EQUAL_UINT32(2, shim_hid_sent);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_tap_held_then_released);
+  RUN_TEST(test_release_waits_for_endpoint);
+  RUN_TEST(test_tap_survives_busy_send);
+  RUN_TEST(test_held_button_not_rescued);
+  RUN_TEST(test_keepalive_sends_live_state);
+  return UNITY_END();
+}
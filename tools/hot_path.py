@@ -0,0 +1,418 @@
+"""
+Hot path placement for PlatformIO (extra_scripts = pre:tools/hot_path.py)
+
+Our own hot functions are tagged HOT_PATH (include/hot_path.h). The
+TinyUSB / Pico-PIO-USB / Adafruit functions they call are compiled with
+-ffunction-sections, so each sits in its own .text.<symbol> section; a
+build middleware renames those to .time_critical.hotpath.<symbol> right
+after the object is built, which the linker script copies to SRAM.
+Toolchain library functions (memcpy) are prebuilt, so their archive
+member is extracted, renamed the same way and linked ahead of the library.
+
+After linking, the call graph is rebuilt from the disassembly: starting
+at HOT_ROOTS, every direct call / tail call (and linker veneer) is
+followed, and the build fails if anything reachable is in flash (XIP,
+0x1xxxxxxx) without an entry in COLD_EXEMPT saying why it may be.
+Indirect calls cannot be followed, so their targets are roots themselves.
+The constants those functions load (literal pool words, movw/movt pairs)
+are checked too: an address of a data object or of a non-executable flash
+section means a table read over XIP, and fails the build the same way.
+
+HOT_PATH_CHECK=warn in the environment reports failures without failing
+the build (e.g. while classifying new findings after a library update).
+"""
+
+import os
+import re
+import subprocess
+
+Import("env")
+
+# Library code on the input -> output path (matched against section suffixes,
+# i.e. mangled names). Static inline helpers fold into these, or get their
+# own section when not inlined - hence the prefixes.
+HOT_LIBRARY_SECTIONS = [
+    # TinyUSB host (core1): transfer completion -> HID report callback -> re-arm
+    r"tuh_task_ext",
+    r"hidh_xfer_cb",
+    r"tuh_hid_receive_report",
+    r"tuh_hid_interface_protocol",
+    r"usbh_edpt_xfer_with_callback",
+    r"usbh_edpt_claim",
+    r"usbh_edpt_release",
+    r"hcd_event_handler",
+    r"hcd_edpt_xfer",
+    r"hcd_int_handler",
+    r"hcd_port_connect_status",
+    # Pico-PIO-USB host port
+    r"pio_usb_host_.*",
+    r"pio_usb_bus_.*",
+    r"pio_usb_ll_.*",
+    r"crc16_tbl",          # USB CRC16 table, read for every packet
+    # TinyUSB device (report submit from core1, completion in tud_task on core0)
+    r"tud_task_ext",
+    r"tud_hid_n_report",
+    r"tud_hid_n_ready",
+    r"tud_mounted",
+    r"tud_suspended",
+    r"hidd_xfer_cb",
+    r"usbd_edpt_xfer",
+    r"usbd_edpt_busy",
+    r"usbd_edpt_claim",
+    r"usbd_edpt_release",
+    r"dcd_edpt_xfer",
+    r"dcd_event_handler",
+    r"tud_event_hook_cb",
+    r"dcd_int_handler",
+    r"dcd_rp2040_irq",
+    r"_?hw_endpoint_.*",
+    r"hw_handle_buff_status",
+    # Shared TinyUSB: event queues (osal -> tu_fifo) and endpoint claim
+    r"_?tu_fifo_.*",
+    r"_ff_.*",
+    r"osal_queue_.*",
+    r"tu_edpt_claim",
+    r"tu_edpt_release",
+    # arduino-pico core (PowerIdle::poll on every core1 loop)
+    r"millis",
+    # Adafruit wrappers
+    r"_ZN17Adafruit_USBD_HID10sendReport.*",
+    r"_ZN17Adafruit_USBD_HID5ready.*",
+    r"tud_hid_report_complete_cb",
+    # Driver tables dereferenced on every transfer
+    r"usbh_class_drivers",
+    r"_usbd_driver",
+]
+
+# Prebuilt toolchain functions on the path: symbol -> archive that defines it
+HOT_ARCHIVE_SYMBOLS = {
+    "memcpy": "libc.a",   # tud_hid_n_report copies the report into the endpoint buffer
+}
+
+# Where the path starts (demangled, without arguments)
+HOT_ROOTS = [
+    # Core1 loop and the input report callback
+    r"core1_main",
+    r"tuh_hid_report_received_cb",
+    # Core0 device task (completes the gamepad transfer) and the USB device ISR
+    r"tud_task_ext",
+    r"dcd_rp2040_irq",
+    # Reached through driver tables / function pointers only
+    r"hidh_xfer_cb",
+    r"hidd_xfer_cb",
+    r"tuh_event_hook_cb",
+]
+
+# Reachable from the roots but allowed in flash - and not followed further.
+# Each entry runs off the per-report path (attach, control requests, errors).
+COLD_EXEMPT = {
+    # Core1 start-up, before the loop
+    r"tuh_init|tuh_rhport_init|tuh_configure|pio_usb_host_init|pio_usb_bus_init|delay":
+        "core1 start-up, runs once before the loop",
+    # Enumeration, hub and mount/unmount handling
+    r"enum_.*|process_enumeration|usbh_driver_set_config_complete|process_removing_device":
+        "attach/detach only",
+    r"tuh_control_xfer|tuh_descriptor_.*|_control_.*|usbh_setup_.*|usbh_get_enum_buf":
+        "host control transfers, attach only",
+    r"hub_.*":
+        "hub status changes, attach/detach only",
+    r"tuh_mount_cb|tuh_umount_cb|tuh_hid_mount_cb|tuh_hid_umount_cb|hidh_open|hidh_set_config|hidh_close":
+        "mount/unmount callbacks, attach/detach only",
+    r"DeviceCache::(mount|unmount|store)":
+        "runs at mount, or once when a new model's input report ID is first seen",
+    r"PowerIdle::(setSpeed|sawAttach)|set_sys_clock_.*|clock_.*|StatusLed::retime|best_effort_wfe_or_timeout":
+        "clock changes and sleep, only while the port is empty or at attach",
+    r"hcd_(port_reset.*|device_close|setup_send|edpt_open|edpt_close)":
+        "host port reset and endpoint setup, attach/detach only",
+    # Device control requests (EP0): enumeration, config channel, telemetry descriptor
+    r"process_control_request|process_set_config|process_get_descriptor|usbd_control_.*|tud_control_.*|hidd_control_xfer_cb|hidd_open":
+        "EP0 control requests, not the gamepad endpoint",
+    r"dcd_(bus_reset|edpt0_.*|sof_enable|set_address|remote_wakeup|edpt_close_all|edpt_open|connect|disconnect)|reset_non_control_endpoints|usbd_reset|tud_(suspend|resume|mount|umount)_cb|invoke_class_.*|configuration_reset":
+        "bus reset, suspend, (re)configuration",
+    # Diagnostics and failures
+    r"panic|hard_assertion_failure|__assert_func|tu_print.*|printf|puts|.*_verbose|tu_desc_.*":
+        "error / debug paths only",
+}
+
+SECTION_RE = re.compile(r"\]\s+\.(text|rodata)\.(\S+)")
+HOT_SECTION_RE = re.compile("(?:%s)$" % "|".join(HOT_LIBRARY_SECTIONS))
+HOT_ROOT_RE = re.compile("(?:%s)$" % "|".join(HOT_ROOTS))
+COLD_EXEMPT_RE = [(re.compile("(?:%s)$" % p), why) for p, why in COLD_EXEMPT.items()]
+FUNC_RE = re.compile(r"^([0-9a-f]+) <(\S+)>:$")
+BRANCH_RE = re.compile(r"^\s*[0-9a-f]+:\s+b[a-z]*(?:\.[nw])?\s+([0-9a-f]+)\b")
+VENEER_RE = re.compile(r"^__(.+)_veneer$")
+WORD_RE = re.compile(r"^\s*[0-9a-f]+:[\s0-9a-f]*\.word\s+0x([0-9a-f]+)\b")
+MOVW_RE = re.compile(r"^\s*[0-9a-f]+:\s+movw(?:\.w)?\s+(\w+),\s*#(\d+)")
+MOVT_RE = re.compile(r"^\s*[0-9a-f]+:\s+movt(?:\.w)?\s+(\w+),\s*#(\d+)")
+ELF_SECTION_RE = re.compile(r"^\s*\[\s*\d+\]\s+(\S+)\s+(\S+)\s+([0-9a-f]+)\s+([0-9a-f]+)\s+([0-9a-f]+)\s+[0-9a-f]+\s+([A-Za-z]*)\s+\d+")
+ELF_SYMBOL_RE = re.compile(r"^\s*\d+:\s+([0-9a-f]+)\s+(\S+)\s+(\w+)\s+\w+\s+\w+\s+\S+\s+(\S+)$")
+STRING_MAX = 40
+FLASH_BASE, FLASH_END = 0x10000000, 0x20000000
+
+
+def _tool(env, name):
+    return env.subst("$OBJCOPY").replace("objcopy", name)
+
+
+def _run(env, args, stdin=None):
+    return subprocess.run(args, env=env["ENV"], input=stdin, capture_output=True,
+                          text=True, check=True).stdout
+
+
+def _hot_renames(env, obj, match, name_for):
+    args = []
+    for kind, name in SECTION_RE.findall(_run(env, [_tool(env, "readelf"), "-SW", obj])):
+        if match(kind, name):
+            args += ["--rename-section", ".%s.%s=.time_critical.hotpath.%s" % (kind, name, name_for(name))]
+    return args
+
+
+def move_hot_sections(target, source, env):
+    obj = str(target[0])
+    args = _hot_renames(env, obj, lambda kind, name: HOT_SECTION_RE.match(name), lambda name: name)
+    if args:
+        _run(env, [env.subst("$OBJCOPY")] + args + [obj])
+    return 0
+
+
+def hot_path_middleware(env, node):
+    obj = env.Object(node)
+    env.AddPostAction(obj, env.VerboseAction(move_hot_sections, "Moving hot path sections to SRAM in $TARGET"))
+    return obj
+
+
+def pull_archive_symbols(env):
+    """Extract the toolchain archive members defining HOT_ARCHIVE_SYMBOLS into
+    the build directory, with their code renamed into the hot path section.
+    Linked as plain objects, they take precedence over the archive."""
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "hot_path")
+    flags = env.subst("$CCFLAGS").split()
+    for sym, lib in HOT_ARCHIVE_SYMBOLS.items():
+        try:
+            archive = _run(env, [env.subst("$CC")] + flags + ["-print-file-name=" + lib]).strip()
+            member = None
+            for line in _run(env, [_tool(env, "nm"), "-A", "--defined-only", archive]).splitlines():
+                # libc.a:lib_a-memcpy.o:00000000 T memcpy
+                parts = line.split()
+                if len(parts) == 3 and parts[1] in "TW" and parts[2] == sym:
+                    member = parts[0].split(":")[-2]
+                    break
+            if not member:
+                raise RuntimeError("%s not defined in %s" % (sym, archive))
+
+            os.makedirs(out_dir, exist_ok=True)
+            _run(env, [_tool(env, "ar"), "x", "--output", out_dir, archive, member])
+            obj = os.path.join(out_dir, member)
+            args = _hot_renames(env, obj, lambda kind, name: kind == "text", lambda name: sym)
+            # Unsuffixed .text (assembly sources)
+            if re.search(r"\]\s+\.text\s", _run(env, [_tool(env, "readelf"), "-SW", obj])):
+                args += ["--rename-section", ".text=.time_critical.hotpath.%s" % sym]
+            if args:
+                _run(env, [env.subst("$OBJCOPY")] + args + [obj])
+            env.Append(LINKFLAGS=[obj])
+        except (OSError, RuntimeError, subprocess.CalledProcessError) as e:
+            # The call graph check reports the symbol if it stays in flash
+            print("Hot path: could not move %s to SRAM (%s)" % (sym, e))
+
+
+def call_graph(disassembly):
+    """Functions (start address, direct callees, constant addresses they load)
+    from objdump -d output. Constants are literal pool words and movw/movt pairs."""
+    funcs, order, current, movw = {}, [], None, {}
+    for line in disassembly.splitlines():
+        m = FUNC_RE.match(line)
+        if m:
+            current = m.group(2)
+            funcs[current] = (int(m.group(1), 16), set(), set())
+            order.append(current)
+            movw = {}
+            continue
+        if not current:
+            continue
+        m = BRANCH_RE.match(line)
+        if m:
+            funcs[current][1].add(int(m.group(1), 16))
+            continue
+        m = WORD_RE.match(line)
+        if m:
+            funcs[current][2].add(int(m.group(1), 16))
+            continue
+        m = MOVW_RE.match(line)
+        if m:
+            movw[m.group(1)] = int(m.group(2))
+            continue
+        m = MOVT_RE.match(line)
+        if m and m.group(1) in movw:
+            funcs[current][2].add((int(m.group(2)) << 16) | movw.pop(m.group(1)))
+
+    by_addr = {}
+    for name in order:
+        by_addr.setdefault(funcs[name][0], name)
+    graph = {}
+    for name in order:
+        addr, targets, refs = funcs[name]
+        callees = {by_addr[t] for t in targets if t in by_addr and t != addr}
+        m = VENEER_RE.match(name)
+        if m and m.group(1) in funcs:
+            callees.add(m.group(1))  # Veneer body is a literal load of the target
+        graph[name] = (addr, callees, refs)
+    return graph
+
+
+def _plain(demangled, name):
+    return demangled.get(name, name).split("(")[0]
+
+
+def _exemption(demangled, name):
+    for regex, why in COLD_EXEMPT_RE:
+        if regex.match(_plain(demangled, name)):
+            return why
+    return None
+
+
+def walk_hot_path(graph, demangled):
+    """Breadth-first from the roots, not entering exempt functions.
+    Returns (reached functions in visit order, caller of each, missing roots)."""
+    roots = [n for n in graph if HOT_ROOT_RE.match(_plain(demangled, n)) and not VENEER_RE.match(n)]
+    parent = {n: None for n in roots}
+    queue, order = list(roots), []
+    while queue:
+        name = queue.pop(0)
+        order.append(name)
+        for callee in sorted(graph[name][1]):
+            if callee not in parent and not _exemption(demangled, callee):
+                parent[callee] = name
+                queue.append(callee)
+    missing = [r for r in HOT_ROOTS if not any(re.match("(?:%s)$" % r, _plain(demangled, n)) for n in roots)]
+    return order, parent, missing
+
+
+def _chain(demangled, parent, name):
+    chain, n = [], parent[name]
+    while n:
+        chain.append(_plain(demangled, n))
+        n = parent[n]
+    return " <- ".join(chain)
+
+
+def find_cold_path(graph, demangled):
+    """Walk from the roots; return (name, address, call chain) for each hot function in flash."""
+    order, parent, missing = walk_hot_path(graph, demangled)
+    in_flash = []
+    for name in order:
+        addr = graph[name][0]
+        if FLASH_BASE <= addr < FLASH_END and not VENEER_RE.match(name):
+            in_flash.append((_plain(demangled, name), addr, _chain(demangled, parent, name)))
+    return in_flash, missing
+
+
+def _data_at(sections, objects, ref):
+    """Name of the flash data at ref, or None when ref is code (a function pointer)."""
+    section = next((s for s in sections if s[1] <= ref < s[1] + s[2]), None)
+    obj = next((o for o in reversed(objects) if o[0] <= ref < o[0] + max(o[1], 1)), None)
+    if obj:
+        return obj[2] if ref == obj[0] else "%s+0x%x" % (obj[2], ref - obj[0])
+    if section and "X" not in section[3]:
+        return "%s+0x%x" % (section[0], ref - section[1])
+    return None
+
+
+def find_flash_data(graph, demangled, sections, objects, read_string):
+    """Constants loaded by hot functions that point at data in flash: a data
+    object, or anything in a non-executable flash section (.rodata, .flashdata,
+    string literals). Code addresses are function pointers, left to HOT_ROOTS.
+    Returns (data, strings), each [(function, address, what, call chain)];
+    strings are NUL-terminated text, i.e. messages for the exempt error calls."""
+    order, parent, _ = walk_hot_path(graph, demangled)
+    data, strings = [], []
+    for name in order:
+        for ref in sorted(graph[name][2]):
+            if not FLASH_BASE <= ref < FLASH_END:
+                continue
+            what = _data_at(sections, objects, ref)
+            if not what:
+                continue
+            text = read_string(ref)
+            entry = (_plain(demangled, name), ref, what if text is None else '"%s"' % text,
+                     _chain(demangled, parent, name) or "root")
+            (data if text is None else strings).append(entry)
+    return data, strings
+
+
+def elf_sections(readelf):
+    """[(name, start, size, flags, type, file offset)] of allocated sections from readelf -SW."""
+    sections = []
+    for m in map(ELF_SECTION_RE.match, readelf.splitlines()):
+        if m and "A" in m.group(6):
+            sections.append((m.group(1), int(m.group(3), 16), int(m.group(5), 16), m.group(6),
+                             m.group(2), int(m.group(4), 16)))
+    return sections
+
+
+def elf_objects(readelf):
+    """Sorted [(start, size, name)] of OBJECT symbols from readelf -sW."""
+    objects = []
+    for m in map(ELF_SYMBOL_RE.match, readelf.splitlines()):
+        if m and m.group(3) == "OBJECT":
+            objects.append((int(m.group(1), 16), int(m.group(2), 0), m.group(4)))
+    return sorted(objects)
+
+
+def _string_reader(elf, sections):
+    """read_string(addr): the NUL-terminated text at addr in the ELF, or None."""
+    def read_string(addr):
+        section = next((s for s in sections if s[1] <= addr < s[1] + s[2] and s[4] == "PROGBITS"), None)
+        if not section:
+            return None
+        with open(elf, "rb") as f:
+            f.seek(section[5] + addr - section[1])
+            raw = f.read(STRING_MAX + 1)
+        end = raw.find(b"\0")
+        text = raw[:end if end >= 0 else STRING_MAX]
+        if end < 4 or not all(32 <= c < 127 or c in (9, 10) for c in text):
+            return None
+        return text.decode().replace("\n", "\\n")
+    return read_string
+
+
+def check_hot_path(target, source, env):
+    elf = str(target[0])
+    graph = call_graph(_run(env, [_tool(env, "objdump"), "-d", "--no-show-raw-insn", elf]))
+    names = sorted(graph)
+    demangled = dict(zip(names, _run(env, [_tool(env, "c++filt")], "\n".join(names)).splitlines()))
+    sections = elf_sections(_run(env, [_tool(env, "readelf"), "-SW", elf]))
+    objects = elf_objects(_run(env, [_tool(env, "readelf"), "-sW", elf]))
+    objects = [(start, size, dem) for (start, size, _), dem in
+               zip(objects, _run(env, [_tool(env, "c++filt")], "\n".join(o[2] for o in objects)).splitlines())]
+
+    status = 0
+    in_flash, missing = find_cold_path(graph, demangled)
+    for root in missing:
+        print("Hot path: root %s not found (inlined or renamed?)" % root)
+    if in_flash:
+        print("Hot path functions placed in flash (add to HOT_LIBRARY_SECTIONS or COLD_EXEMPT):")
+        for name, addr, chain in in_flash:
+            print("  0x%08x %s  (via %s)" % (addr, name, chain or "root"))
+        status = 1
+
+    data, strings = find_flash_data(graph, demangled, sections, objects, _string_reader(elf, sections))
+    if data:
+        print("Hot path functions reading data in flash (make it non-const, add its section to "
+              "HOT_LIBRARY_SECTIONS, or exempt the function in COLD_EXEMPT):")
+        for name, addr, what, chain in data:
+            print("  0x%08x %s  read by %s  (via %s)" % (addr, what, name, chain))
+        status = 1
+    for name, addr, what, chain in strings:
+        print("Hot path note: %s loads string 0x%08x %s (message for an error/debug call)" % (name, addr, what))
+
+    if not status:
+        print("Hot path check: every function reachable from the roots, and the data they load, is in SRAM")
+    elif os.environ.get("HOT_PATH_CHECK") == "warn":
+        print("Hot path check failed (HOT_PATH_CHECK=warn, not failing the build)")
+        return 0
+    return status
+
+
+env.AddBuildMiddleware(hot_path_middleware)
+pull_archive_symbols(env)
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", env.VerboseAction(check_hot_path, "Checking hot path placement"))
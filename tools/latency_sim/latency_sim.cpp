@@ -0,0 +1,401 @@
+/************************************************************************
+Bridge Latency Simulator
+Discrete-event model of the input -> core1 -> core0 -> output pipeline
+
+Usage: latency_sim <config.cfg> [more.cfg ...]
+
+Each config file describes one pipeline variant (see configs/). Core1
+decode cost is measured by running the real forwardHIDReport() from
+src/pro_controller_output.cpp natively and scaling by cpu_scale.
+*************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pro_controller_output.h"
+
+RP2040 rp2040;
+Adafruit_USBD_Device USBDevice;
+
+// ----------------------------------------------------------------------
+// Configuration
+// ----------------------------------------------------------------------
+
+struct SimConfig {
+  std::string name;
+  double in_interval_us = 1000;     // PIO-USB host poll interval for the controller
+  double in_jitter_us = 0;          // Uniform +/- jitter on each input poll
+  double in_sample_age_us = 0;      // Controller-side age of the sampled state
+  double core1_overhead_us = 20;    // tuh_task + PIO-USB completion, excluding decode
+  double decode_us = -1;            // Override measured decode cost (< 0 = measure)
+  double cpu_scale = 30;            // Device time per host time for the decoder
+  std::string handoff = "direct";   // direct: core1 sends | mailbox: core0 sends latest
+  double handoff_us = 1;            // Cross-core mailbox visibility delay
+  double core0_loop_us = 1000;      // delay() between loop() iterations
+  double core0_task_us = 5;         // tud_task() cost per iteration
+  double keepalive_ms = 100;        // Periodic resend from core0 (0 = off)
+  double out_interval_us = 4000;    // setPollInterval() as polled by the host
+  double out_clock_ppm = 50;        // Host frame clock offset vs. the bridge
+  bool sof_align = false;           // Only the input report finishing just before a poll is sent
+  double sof_margin_us = 50;        // Slack left before the output poll when aligned
+  std::string rearm = "task";       // task: endpoint freed in tud_task | isr: freed on completion
+  bool coalesce = false;            // Keep latest report pending while the endpoint is busy
+  double duration_s = 30;
+  uint32_t events = 200000;         // Random input changes sampled for the percentiles
+  uint32_t seed = 1;
+};
+
+static std::string trim(const std::string& s) {
+  size_t b = s.find_first_not_of(" \t\r\n");
+  size_t e = s.find_last_not_of(" \t\r\n");
+  return b == std::string::npos ? "" : s.substr(b, e - b + 1);
+}
+
+static bool parseBool(const std::string& v) {
+  return v == "1" || v == "true" || v == "yes" || v == "on";
+}
+
+static bool loadConfig(const char* path, SimConfig* cfg) {
+  std::ifstream f(path);
+  if (!f) {
+    fprintf(stderr, "latency_sim: cannot open %s\n", path);
+    return false;
+  }
+
+  cfg->name = path;
+  std::string line;
+  int lineno = 0;
+  while (std::getline(f, line)) {
+    lineno++;
+    size_t hash = line.find('#');
+    if (hash != std::string::npos) line.erase(hash);
+    line = trim(line);
+    if (line.empty()) continue;
+
+    size_t eq = line.find('=');
+    if (eq == std::string::npos) {
+      fprintf(stderr, "%s:%d: expected key = value\n", path, lineno);
+      return false;
+    }
+    std::string key = trim(line.substr(0, eq));
+    std::string val = trim(line.substr(eq + 1));
+    double num = atof(val.c_str());
+
+    if (key == "name") cfg->name = val;
+    else if (key == "in_interval_us") cfg->in_interval_us = num;
+    else if (key == "in_jitter_us") cfg->in_jitter_us = num;
+    else if (key == "in_sample_age_us") cfg->in_sample_age_us = num;
+    else if (key == "core1_overhead_us") cfg->core1_overhead_us = num;
+    else if (key == "decode_us") cfg->decode_us = num;
+    else if (key == "cpu_scale") cfg->cpu_scale = num;
+    else if (key == "handoff") cfg->handoff = val;
+    else if (key == "handoff_us") cfg->handoff_us = num;
+    else if (key == "core0_loop_us") cfg->core0_loop_us = num;
+    else if (key == "core0_task_us") cfg->core0_task_us = num;
+    else if (key == "keepalive_ms") cfg->keepalive_ms = num;
+    else if (key == "out_interval_us") cfg->out_interval_us = num;
+    else if (key == "out_clock_ppm") cfg->out_clock_ppm = num;
+    else if (key == "sof_align") cfg->sof_align = parseBool(val);
+    else if (key == "sof_margin_us") cfg->sof_margin_us = num;
+    else if (key == "rearm") cfg->rearm = val;
+    else if (key == "coalesce") cfg->coalesce = parseBool(val);
+    else if (key == "duration_s") cfg->duration_s = num;
+    else if (key == "events") cfg->events = (uint32_t)num;
+    else if (key == "seed") cfg->seed = (uint32_t)num;
+    else {
+      fprintf(stderr, "%s:%d: unknown key '%s'\n", path, lineno, key.c_str());
+      return false;
+    }
+  }
+
+  if (cfg->handoff != "direct" && cfg->handoff != "mailbox") {
+    fprintf(stderr, "%s: handoff must be direct or mailbox\n", path);
+    return false;
+  }
+  if (cfg->rearm != "task" && cfg->rearm != "isr") {
+    fprintf(stderr, "%s: rearm must be task or isr\n", path);
+    return false;
+  }
+  if (cfg->in_interval_us <= 0 || cfg->out_interval_us <= 0 ||
+      cfg->core0_loop_us + cfg->core0_task_us <= 0) {
+    fprintf(stderr, "%s: intervals must be positive\n", path);
+    return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------
+// Decoder cost (real code, compiled natively)
+// ----------------------------------------------------------------------
+
+// Measure forwardHIDReport() for a Pro 2 report in host microseconds
+static double measureDecodeHostUs() {
+  static ProControllerOutput output;
+  uint8_t report[64] = {0};
+  report[0] = 0x05;
+
+  const int iterations = 2000000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    // Vary buttons and sticks so the decoder cannot be hoisted out of the loop
+    report[4] = (uint8_t)i;
+    report[6] = (uint8_t)(i >> 8);
+    report[10] = (uint8_t)(i * 7);
+    report[13] = (uint8_t)(i * 13);
+    forwardHIDReport(report, sizeof(report), &output);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  volatile uint8_t sink = output.getReport()->lx;
+  (void)sink;
+  return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+// ----------------------------------------------------------------------
+// Discrete-event pipeline model
+// ----------------------------------------------------------------------
+
+enum EventType { EV_INPUT_POLL, EV_CORE1_DONE, EV_MAILBOX, EV_CORE0_LOOP, EV_HOST_POLL };
+
+struct Event {
+  double t;
+  EventType type;
+  int64_t idx;
+  bool operator>(const Event& o) const { return t > o.t; }
+};
+
+enum EndpointState { EP_FREE, EP_LOADED, EP_WAIT_REARM };
+
+struct SimResult {
+  std::vector<double> latency_us;
+  uint64_t reports_in = 0;
+  uint64_t reports_out = 0;
+  uint64_t dropped = 0;
+  double decode_us = 0;
+};
+
+class PipelineSim {
+  private:
+    const SimConfig& cfg;
+    std::mt19937_64 rng;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> queue;
+
+    std::vector<double> sample_time;              // Per input report
+    std::vector<std::pair<double, int64_t>> rx;   // Host receive time, report index
+
+    double decode_us;
+    double out_interval = 0;
+    double out_phase = 0;
+    double core1_free = 0;
+    EndpointState ep = EP_FREE;
+    int64_t ep_idx = -1;
+    int64_t pending_idx = -1;
+    int64_t mailbox_idx = -1;
+    int64_t mailbox_sent = -1;
+    int64_t latest_idx = -1;
+    double last_keepalive = 0;
+    uint64_t dropped = 0;
+
+    void push(double t, EventType type, int64_t idx = -1) {
+      queue.push(Event{t, type, idx});
+    }
+
+    // sendReport(): claim the endpoint or fail like tud_hid_report() does
+    void trySend(int64_t idx) {
+      if (idx < 0) return;
+      if (ep == EP_FREE) {
+        ep = EP_LOADED;
+        ep_idx = idx;
+      } else if (cfg.coalesce) {
+        pending_idx = idx;
+      } else {
+        dropped++;
+      }
+    }
+
+    // True if t is the last input completion before the next host poll
+    bool dueBeforeHostPoll(double t) const {
+      double since = fmod(t - out_phase, out_interval);
+      if (since < 0) since += out_interval;
+      return out_interval - since <= cfg.in_interval_us;
+    }
+
+    // Endpoint became free - coalesced report goes out next
+    void rearm() {
+      ep = EP_FREE;
+      if (pending_idx >= 0) {
+        int64_t idx = pending_idx;
+        pending_idx = -1;
+        trySend(idx);
+      }
+    }
+
+  public:
+    PipelineSim(const SimConfig& c, double decode) : cfg(c), rng(c.seed), decode_us(decode) {}
+
+    SimResult run() {
+      std::uniform_real_distribution<double> unit(0.0, 1.0);
+      double end_us = cfg.duration_s * 1e6;
+      out_interval = cfg.out_interval_us * (1.0 + cfg.out_clock_ppm * 1e-6);
+      out_phase = unit(rng) * out_interval;
+      double in_phase = unit(rng) * cfg.in_interval_us;
+      double core0_phase = unit(rng) * (cfg.core0_loop_us + cfg.core0_task_us);
+
+      if (cfg.sof_align) {
+        // Input poll lands so core1 finishes sof_margin_us before an output poll
+        out_interval = cfg.out_interval_us;
+        double lead = cfg.core1_overhead_us + decode_us + cfg.sof_margin_us;
+        in_phase = fmod(out_phase - lead + 10 * cfg.out_interval_us, cfg.in_interval_us);
+      }
+
+      push(in_phase, EV_INPUT_POLL);
+      push(core0_phase, EV_CORE0_LOOP);
+      push(out_phase, EV_HOST_POLL);
+
+      while (!queue.empty()) {
+        Event ev = queue.top();
+        queue.pop();
+        if (ev.t > end_us) break;
+
+        switch (ev.type) {
+          case EV_INPUT_POLL: {
+            int64_t idx = (int64_t)sample_time.size();
+            sample_time.push_back(ev.t - cfg.in_sample_age_us);
+            double start = std::max(ev.t, core1_free);
+            core1_free = start + cfg.core1_overhead_us + decode_us;
+            push(core1_free, EV_CORE1_DONE, idx);
+
+            double next = in_phase + (idx + 1) * cfg.in_interval_us;
+            if (cfg.in_jitter_us > 0) next += (unit(rng) * 2 - 1) * cfg.in_jitter_us;
+            push(std::max(next, ev.t), EV_INPUT_POLL);
+            break;
+          }
+
+          case EV_CORE1_DONE:
+            latest_idx = std::max(latest_idx, ev.idx);
+            if (cfg.sof_align && !dueBeforeHostPoll(ev.t)) {
+              // Aligned mode only sends the report phased in front of a poll
+            } else if (cfg.handoff == "direct") {
+              trySend(ev.idx);
+            } else {
+              push(ev.t + cfg.handoff_us, EV_MAILBOX, ev.idx);
+            }
+            break;
+
+          case EV_MAILBOX:
+            mailbox_idx = std::max(mailbox_idx, ev.idx);
+            break;
+
+          case EV_CORE0_LOOP: {
+            // tud_task(): completions processed, endpoint re-armed
+            double t = ev.t + cfg.core0_task_us;
+            if (ep == EP_WAIT_REARM) rearm();
+            if (cfg.handoff == "mailbox" && mailbox_idx > mailbox_sent) {
+              mailbox_sent = mailbox_idx;
+              trySend(mailbox_idx);
+            }
+            if (cfg.keepalive_ms > 0 && t - last_keepalive >= cfg.keepalive_ms * 1000) {
+              trySend(latest_idx);
+              last_keepalive = t;
+            }
+            push(t + cfg.core0_loop_us, EV_CORE0_LOOP);
+            break;
+          }
+
+          case EV_HOST_POLL:
+            if (ep == EP_LOADED) {
+              rx.push_back(std::make_pair(ev.t, ep_idx));
+              ep = EP_WAIT_REARM;
+              if (cfg.rearm == "isr") rearm();
+            }
+            push(ev.t + out_interval, EV_HOST_POLL);
+            break;
+        }
+      }
+
+      return collect();
+    }
+
+  private:
+    SimResult collect() {
+      SimResult res;
+      res.reports_in = sample_time.size();
+      res.reports_out = rx.size();
+      res.dropped = dropped;
+      res.decode_us = decode_us;
+      if (rx.empty() || sample_time.size() < 2) return res;
+
+      // First host receive carrying each input report (or a newer one)
+      std::vector<double> first_rx(sample_time.size(), -1);
+      int64_t filled = -1;
+      for (const auto& r : rx) {
+        for (int64_t k = filled + 1; k <= r.second; k++) first_rx[k] = r.first;
+        filled = std::max(filled, r.second);
+      }
+
+      // Random input changes: visible in the first report sampled after them
+      std::uniform_real_distribution<double> when(sample_time.front(), sample_time[filled]);
+      res.latency_us.reserve(cfg.events);
+      for (uint32_t i = 0; i < cfg.events; i++) {
+        double e = when(rng);
+        size_t k = std::lower_bound(sample_time.begin(), sample_time.end(), e) - sample_time.begin();
+        if (k >= first_rx.size() || first_rx[k] < 0) continue;
+        res.latency_us.push_back(first_rx[k] - e);
+      }
+      std::sort(res.latency_us.begin(), res.latency_us.end());
+      return res;
+    }
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t i = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(i, sorted.size() - 1)];
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <config.cfg> [more.cfg ...]\n", argv[0]);
+    return 2;
+  }
+
+  double host_decode_us = measureDecodeHostUs();
+  printf("forwardHIDReport (Pro 2): %.4f us/report on host\n\n", host_decode_us);
+  printf("%-24s %8s %8s %8s %8s %8s %8s %9s\n",
+         "config", "decode", "mean", "p50", "p90", "p99", "p99.9", "dropped");
+
+  int status = 0;
+  for (int i = 1; i < argc; i++) {
+    SimConfig cfg;
+    if (!loadConfig(argv[i], &cfg)) {
+      status = 1;
+      continue;
+    }
+
+    double decode_us = cfg.decode_us >= 0 ? cfg.decode_us : host_decode_us * cfg.cpu_scale;
+    SimResult res = PipelineSim(cfg, decode_us).run();
+
+    double mean = 0;
+    for (double v : res.latency_us) mean += v;
+    if (!res.latency_us.empty()) mean /= res.latency_us.size();
+
+    // Latencies in milliseconds, decode cost in microseconds
+    printf("%-24s %7.2fu %8.3f %8.3f %8.3f %8.3f %8.3f %9llu\n",
+           cfg.name.c_str(), res.decode_us, mean / 1000,
+           percentile(res.latency_us, 50) / 1000,
+           percentile(res.latency_us, 90) / 1000,
+           percentile(res.latency_us, 99) / 1000,
+           percentile(res.latency_us, 99.9) / 1000,
+           (unsigned long long)res.dropped);
+  }
+  return status;
+}
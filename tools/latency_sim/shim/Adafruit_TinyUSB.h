@@ -0,0 +1,39 @@
+/************************************************************************
+Adafruit_TinyUSB.h shim for the host-side latency simulator
+Device-side HID calls become no-ops so the decoders can be timed natively;
+unit tests can hold the endpoint busy and inspect the last report sent
+*************************************************************************/
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// Endpoint state shared by every shim HID interface
+inline bool shim_hid_busy = false;
+inline uint8_t shim_hid_last[64];
+inline uint32_t shim_hid_sent = 0;
+
+class Adafruit_USBD_HID {
+  public:
+    void setPollInterval(uint8_t interval_ms) { (void)interval_ms; }
+    void setReportDescriptor(const uint8_t* desc, uint16_t len) { (void)desc; (void)len; }
+    bool begin() { return true; }
+    bool ready() { return !shim_hid_busy; }
+    bool sendReport(uint8_t report_id, const void* report, uint8_t len) {
+      (void)report_id;
+      if (shim_hid_busy) return false;
+      memcpy(shim_hid_last, report, len < sizeof(shim_hid_last) ? len : sizeof(shim_hid_last));
+      shim_hid_sent++;
+      return true;
+    }
+};
+
+class Adafruit_USBD_Device {
+  public:
+    void setID(uint16_t vid, uint16_t pid) { (void)vid; (void)pid; }
+    void setDeviceVersion(uint16_t bcd) { (void)bcd; }
+    void setManufacturerDescriptor(const char* s) { (void)s; }
+    void setProductDescriptor(const char* s) { (void)s; }
+    bool mounted() { return true; }
+};
+extern Adafruit_USBD_Device USBDevice;
@@ -0,0 +1,19 @@
+/************************************************************************
+Arduino.h shim for the host-side latency simulator
+Provides just enough of the arduino-pico core to compile the decoders
+*************************************************************************/
+
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cycle counter stand-in (always returns 0 on host)
+class RP2040 {
+  public:
+    uint32_t getCycleCount() { return 0; }
+};
+extern RP2040 rp2040;
+
+inline void delay(unsigned long ms) { (void)ms; }
+inline uint32_t time_us_32() { return 0; }
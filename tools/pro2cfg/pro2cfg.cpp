@@ -0,0 +1,331 @@
+/************************************************************************
+pro2cfg - Linux CLI for the bridge's vendor config interface (hidraw)
+
+Usage: pro2cfg [-d /dev/hidrawN] show
+       pro2cfg [-d /dev/hidrawN] diag
+       pro2cfg [-d /dev/hidrawN] defaults
+       pro2cfg [-d /dev/hidrawN] set key=value [key=value ...]
+       pro2cfg [-d /dev/hidrawN] monitor    (telemetry interface)
+
+Keys: gyro=on|off  gyro_sens=<Q8.8>  gyro_deadband=<n>  ratchet=<button|none>
+      deadzone=<0-2046>  curve=<9 comma separated points 0-2048>
+      interval=<1-16 ms>  mode=switch|pc  (both re-enumerate the bridge)
+      reset_stats=1  clear_cache=1  map.<button>=<0-31|none>  (16+ only in pc mode)
+*************************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/hidraw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "bridge_config.h"
+#include "pro_controller_output.h"
+#include "telemetry_stream.h"
+
+// How long to wait for a written config to be published (20 x 5 ms)
+#define CONFIG_CONFIRM_POLLS    20
+#define CONFIG_CONFIRM_POLL_US  5000
+
+// Pro 2 button bit names (see parseSwitchPro2Report)
+static const char* PRO2_BUTTON_NAMES[32] = {
+  "Y", "X", "B", "A", "SR-Right", "SL-Right", "R", "ZR",
+  "Minus", "Plus", "R-Stick", "L-Stick", "Home", "Capture", "C", "bit15",
+  "Down", "Up", "Right", "Left", "SR-Left", "SL-Left", "L", "ZL",
+  "GR", "GL", "bit26", "bit27", "Headset", "bit29", "bit30", "bit31",
+};
+
+static int buttonIndex(const char* name) {
+  for (int i = 0; i < 32; i++) {
+    if (strcasecmp(name, PRO2_BUTTON_NAMES[i]) == 0) return i;
+  }
+  return -1;
+}
+
+// The bridge in either output mode (HORIPAD identity or the PC one)
+static bool isBridge(const struct hidraw_devinfo* info) {
+  uint16_t vid = info->vendor & 0xFFFF, pid = info->product & 0xFFFF;
+  return (vid == GAMEPAD_VID && pid == GAMEPAD_PID) || (vid == GAMEPAD_PC_VID && pid == GAMEPAD_PC_PID);
+}
+
+// Find one of the bridge's vendor interfaces (usage page 0xFFnn) among /dev/hidraw*
+static int openBridge(const char* path, uint8_t usage_page) {
+  if (path) return open(path, O_RDWR);
+
+  DIR* dir = opendir("/dev");
+  if (!dir) return -1;
+
+  int fd = -1;
+  struct dirent* ent;
+  while (fd < 0 && (ent = readdir(dir)) != NULL) {
+    if (strncmp(ent->d_name, "hidraw", 6) != 0) continue;
+
+    char dev[300];
+    snprintf(dev, sizeof(dev), "/dev/%s", ent->d_name);
+    int cand = open(dev, O_RDWR);
+    if (cand < 0) continue;
+
+    struct hidraw_devinfo info;
+    struct hidraw_report_descriptor desc;
+    int desc_size = 0;
+    bool match = ioctl(cand, HIDIOCGRAWINFO, &info) == 0 && isBridge(&info) &&
+                 ioctl(cand, HIDIOCGRDESCSIZE, &desc_size) == 0 && desc_size >= 3;
+    if (match) {
+      desc.size = desc_size;
+      match = ioctl(cand, HIDIOCGRDESC, &desc) == 0 &&
+              desc.value[0] == 0x06 && desc.value[1] == usage_page && desc.value[2] == 0xFF;
+    }
+
+    if (match) {
+      fd = cand;
+    } else {
+      close(cand);
+    }
+  }
+  closedir(dir);
+  return fd;
+}
+
+static bool getFeature(int fd, uint8_t report_id, void* out, size_t len) {
+  uint8_t buf[BRIDGE_REPORT_SIZE + 1] = {0};
+  buf[0] = report_id;
+  int res = ioctl(fd, HIDIOCGFEATURE(sizeof(buf)), buf);
+  if (res < (int)(len + 1)) return false;
+  memcpy(out, buf + 1, len);
+  return true;
+}
+
+static bool readConfig(int fd, BridgeConfigData_t* cfg) {
+  return getFeature(fd, BRIDGE_CONFIG_REPORT_ID, cfg, sizeof(*cfg)) && cfg->version == BRIDGE_CONFIG_VERSION;
+}
+
+static bool readDiag(int fd, BridgeDiag_t* diag) {
+  return getFeature(fd, BRIDGE_DIAG_REPORT_ID, diag, sizeof(*diag));
+}
+
+// Write the config and confirm the bridge published it
+static bool writeConfig(int fd, const BridgeConfigData_t* cfg) {
+  BridgeDiag_t before;
+  if (!readDiag(fd, &before)) return false;
+
+  uint8_t buf[BRIDGE_REPORT_SIZE + 1] = {0};
+  buf[0] = BRIDGE_CONFIG_REPORT_ID;
+  memcpy(buf + 1, cfg, sizeof(*cfg));
+  if (ioctl(fd, HIDIOCSFEATURE(sizeof(buf)), buf) < 0) return false;
+
+  // Published from the bridge's main loop, normally within a millisecond or two
+  for (int i = 0; i < CONFIG_CONFIRM_POLLS; i++) {
+    BridgeDiag_t after;
+    if (!readDiag(fd, &after)) return false;
+    if (after.config_generation != before.config_generation) return true;
+    usleep(CONFIG_CONFIRM_POLL_US);
+  }
+  return false;
+}
+
+static void printConfig(const BridgeConfigData_t* cfg) {
+  printf("gyro          %s\n", (cfg->flags & BRIDGE_FLAG_GYRO_AIM) ? "on" : "off");
+  printf("gyro_sens     %d (Q8.8)\n", cfg->gyro_sensitivity);
+  printf("gyro_deadband %u\n", cfg->gyro_deadband);
+  printf("ratchet       %s\n", cfg->gyro_ratchet_bit < 32 ? PRO2_BUTTON_NAMES[cfg->gyro_ratchet_bit] : "none");
+  printf("deadzone      %u\n", cfg->stick_deadzone);
+  printf("curve         ");
+  for (int i = 0; i < BRIDGE_CURVE_POINTS; i++) {
+    printf("%u%s", cfg->stick_curve[i], i + 1 < BRIDGE_CURVE_POINTS ? "," : "\n");
+  }
+  printf("interval      %u ms\n", cfg->output_interval_ms);
+  printf("mode          %s\n", cfg->output_mode == BRIDGE_OUTPUT_PC_HIRES ? "pc" : "switch");
+  printf("map:\n");
+  for (int i = 0; i < 32; i++) {
+    if (cfg->button_map[i] != BRIDGE_BUTTON_NONE) {
+      printf("  %-9s -> %u\n", PRO2_BUTTON_NAMES[i], cfg->button_map[i]);
+    }
+  }
+}
+
+static void printDiag(const BridgeDiag_t* diag) {
+  printf("reports_in        %u\n", diag->reports_in);
+  printf("reports_sent      %u\n", diag->reports_sent);
+  printf("send_busy         %u\n", diag->send_busy);
+  printf("config_generation %u\n", diag->config_generation);
+  printf("gyro_max_cycles   %u\n", diag->gyro_max_cycles);
+  printf("gyro_over_budget  %u\n", diag->gyro_over_budget);
+  printf("taps_rescued      %u\n", diag->taps_rescued);
+  printf("telemetry_dropped %u\n", diag->telemetry_dropped);
+  printf("attach_to_report  %u us\n", diag->attach_to_report_us);
+  printf("cache_hits        %u\n", diag->cache_hits);
+}
+
+// Print telemetry records until interrupted
+static int monitor(int fd) {
+  TelemetryReport_t rec;
+  uint32_t last_us = 0;
+  uint16_t next_seq = 0;
+  bool first = true;
+
+  printf("   seq    dt_us  buttons     lx   ly   rx   ry   gyro_x gyro_y gyro_z  dropped\n");
+  while (true) {
+    ssize_t n = read(fd, &rec, sizeof(rec));
+    if (n < 0) {
+      fprintf(stderr, "pro2cfg: telemetry read failed (%s)\n", strerror(errno));
+      return 1;
+    }
+    if (n != (ssize_t)sizeof(rec) || rec.version != TELEMETRY_VERSION) continue;
+
+    if (!first && rec.seq != next_seq) {
+      printf("  -- %u records missed\n", (uint16_t)(rec.seq - next_seq));
+    }
+    printf("%6u %8u %08x  %4u %4u %4u %4u", rec.seq, first ? 0 : rec.timestamp_us - last_us,
+           rec.buttons32, rec.lx, rec.ly, rec.rx, rec.ry);
+    if (rec.flags & TELEMETRY_FLAG_IMU) {
+      printf("  %6d %6d %6d", rec.gyro[0], rec.gyro[1], rec.gyro[2]);
+    } else {
+      printf("  %6s %6s %6s", "-", "-", "-");
+    }
+    printf("  %7u\n", rec.dropped);
+    fflush(stdout);
+
+    first = false;
+    last_us = rec.timestamp_us;
+    next_seq = rec.seq + 1;
+  }
+}
+
+static bool applySetting(BridgeConfigData_t* cfg, const char* arg) {
+  char key[32];
+  const char* eq = strchr(arg, '=');
+  if (!eq || (size_t)(eq - arg) >= sizeof(key)) return false;
+  memcpy(key, arg, eq - arg);
+  key[eq - arg] = '\0';
+  const char* val = eq + 1;
+
+  if (strcmp(key, "gyro") == 0) {
+    if (strcmp(val, "on") == 0) cfg->flags |= BRIDGE_FLAG_GYRO_AIM;
+    else if (strcmp(val, "off") == 0) cfg->flags &= ~BRIDGE_FLAG_GYRO_AIM;
+    else return false;
+  } else if (strcmp(key, "gyro_sens") == 0) {
+    cfg->gyro_sensitivity = (int16_t)strtol(val, NULL, 0);
+  } else if (strcmp(key, "gyro_deadband") == 0) {
+    cfg->gyro_deadband = (uint16_t)strtoul(val, NULL, 0);
+  } else if (strcmp(key, "ratchet") == 0) {
+    int idx = buttonIndex(val);
+    if (idx < 0 && strcmp(val, "none") != 0) return false;
+    cfg->gyro_ratchet_bit = idx < 0 ? BRIDGE_BUTTON_NONE : idx;
+  } else if (strcmp(key, "deadzone") == 0) {
+    cfg->stick_deadzone = (uint16_t)strtoul(val, NULL, 0);
+  } else if (strcmp(key, "curve") == 0) {
+    char* p = (char*)val;
+    for (int i = 0; i < BRIDGE_CURVE_POINTS; i++) {
+      cfg->stick_curve[i] = (uint16_t)strtoul(p, &p, 0);
+      if (i + 1 < BRIDGE_CURVE_POINTS && *p++ != ',') return false;
+    }
+  } else if (strcmp(key, "interval") == 0) {
+    cfg->output_interval_ms = (uint8_t)strtoul(val, NULL, 0);
+  } else if (strcmp(key, "mode") == 0) {
+    if (strcmp(val, "switch") == 0) cfg->output_mode = BRIDGE_OUTPUT_SWITCH;
+    else if (strcmp(val, "pc") == 0) cfg->output_mode = BRIDGE_OUTPUT_PC_HIRES;
+    else return false;
+  } else if (strcmp(key, "reset_stats") == 0) {
+    if (atoi(val)) cfg->diag_flags |= BRIDGE_DIAG_RESET_STATS;
+    else cfg->diag_flags &= ~BRIDGE_DIAG_RESET_STATS;
+  } else if (strcmp(key, "clear_cache") == 0) {
+    if (atoi(val)) cfg->diag_flags |= BRIDGE_DIAG_CLEAR_DEVICE_CACHE;
+    else cfg->diag_flags &= ~BRIDGE_DIAG_CLEAR_DEVICE_CACHE;
+  } else if (strncmp(key, "map.", 4) == 0) {
+    int idx = buttonIndex(key + 4);
+    if (idx < 0) return false;
+    if (strcmp(val, "none") == 0) {
+      cfg->button_map[idx] = BRIDGE_BUTTON_NONE;
+    } else {
+      cfg->button_map[idx] = (uint8_t)strtoul(val, NULL, 0);
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static int usage(const char* prog) {
+  fprintf(stderr, "Usage: %s [-d /dev/hidrawN] show|diag|defaults|monitor|set key=value ...\n", prog);
+  return 2;
+}
+
+int main(int argc, char** argv) {
+  const char* dev = NULL;
+  int argi = 1;
+  if (argi + 1 < argc && strcmp(argv[argi], "-d") == 0) {
+    dev = argv[argi + 1];
+    argi += 2;
+  }
+  if (argi >= argc) return usage(argv[0]);
+  const char* cmd = argv[argi++];
+
+  bool telemetry = strcmp(cmd, "monitor") == 0;
+  int fd = openBridge(dev, telemetry ? 0x01 : 0x00);
+  if (fd < 0) {
+    fprintf(stderr, "pro2cfg: bridge %s interface not found (%s)\n", telemetry ? "telemetry" : "config",
+            dev ? strerror(errno) : "no matching /dev/hidraw*");
+    return 1;
+  }
+  if (telemetry) {
+    int status = monitor(fd);
+    close(fd);
+    return status;
+  }
+
+  int status = 0;
+  BridgeConfigData_t cfg;
+  BridgeDiag_t diag;
+
+  if (strcmp(cmd, "show") == 0) {
+    if (readConfig(fd, &cfg)) {
+      printConfig(&cfg);
+    } else {
+      fprintf(stderr, "pro2cfg: failed to read config\n");
+      status = 1;
+    }
+  } else if (strcmp(cmd, "diag") == 0) {
+    if (readDiag(fd, &diag)) {
+      printDiag(&diag);
+    } else {
+      fprintf(stderr, "pro2cfg: failed to read diagnostics\n");
+      status = 1;
+    }
+  } else if (strcmp(cmd, "defaults") == 0 || strcmp(cmd, "set") == 0) {
+    if (strcmp(cmd, "defaults") == 0) {
+      bridgeConfigDefaults(&cfg);
+    } else if (!readConfig(fd, &cfg)) {
+      fprintf(stderr, "pro2cfg: failed to read config\n");
+      close(fd);
+      return 1;
+    }
+    cfg.diag_flags &= ~(BRIDGE_DIAG_RESET_STATS | BRIDGE_DIAG_CLEAR_DEVICE_CACHE);
+
+    for (; argi < argc; argi++) {
+      if (!applySetting(&cfg, argv[argi])) {
+        fprintf(stderr, "pro2cfg: bad setting '%s'\n", argv[argi]);
+        close(fd);
+        return 2;
+      }
+    }
+
+    if (!bridgeConfigValid(&cfg)) {
+      fprintf(stderr, "pro2cfg: resulting config is out of range\n");
+      status = 1;
+    } else if (!writeConfig(fd, &cfg)) {
+      fprintf(stderr, "pro2cfg: bridge did not accept the config\n");
+      status = 1;
+    } else {
+      printConfig(&cfg);
+    }
+  } else {
+    status = usage(argv[0]);
+  }
+
+  close(fd);
+  return status;
+}